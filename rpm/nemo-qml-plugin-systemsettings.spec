@@ -90,6 +90,8 @@ fi
 %{_libdir}/qt5/qml/org/nemomobile/systemsettings/qmldir
 %{_libdir}/libsystemsettings.so.*
 %attr(4710,-,privileged) %{_libexecdir}/setlocale
+%{_datadir}/dbus-1/system-services/org.nemomobile.systemsettings.setlocale.service
+%config %{_sysconfdir}/dbus-1/system.d/org.nemomobile.systemsettings.setlocale.conf
 %dir %attr(0775, root, privileged) /etc/location
 %config %attr(0664, root, privileged) /etc/location/location.conf
 %dir %attr(0775, root, privileged) /var/lib/location
@@ -105,6 +107,8 @@ fi
 %files tests
 %defattr(-,root,root,-)
 /opt/tests/%{name}-tests/ut_diskusage
+/opt/tests/%{name}-tests/ut_timezoneinfo
+/opt/tests/%{name}-tests/bm_udisks2
 /opt/tests/%{name}-tests/tests.xml
 
 %files ts-devel
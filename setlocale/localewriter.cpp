@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "localewriter.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QDebug>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static bool ensureDirectory(QString filePath)
+{
+    auto directory = QFileInfo(filePath).dir();
+
+    if (directory.exists())
+        return true;
+
+    // Ensure parent with correct rights (recursion)
+    if (!ensureDirectory(directory.path()))
+        return false;
+
+    // Create this directory
+    if (!directory.mkpath(QStringLiteral(".")))
+        return false;
+
+    // Set correct access perms, root:root 755
+    auto pathArray = directory.path().toUtf8();
+    const char *path = pathArray.data();
+
+    if (chmod(path, S_IWUSR | S_IRUSR | S_IXUSR | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == -1)
+        qWarning() << "Failed to set directory permissions" << directory.path() << ":" << strerror(errno);
+
+    if (chown(path, 0, 0) == -1)
+        qWarning() << "Failed to set directory as root:root" << directory.path() << ":" << strerror(errno);
+
+    return true;
+}
+
+static bool writeAll(int fd, const QByteArray &data)
+{
+    const char *position = data.constData();
+    ssize_t remaining = data.size();
+    while (remaining > 0) {
+        const ssize_t written = write(fd, position, remaining);
+        if (written == -1) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        position += written;
+        remaining -= written;
+    }
+    return true;
+}
+
+bool isValidLocale(const QString &locale)
+{
+    static const QRegularExpression allowedInput("^[a-zA-Z0-9\\.@_]*$");
+    return allowedInput.match(locale).hasMatch();
+}
+
+bool writeLocale(const QString &configPath, const QString &locale)
+{
+    if (!ensureDirectory(configPath)) {
+        qWarning() << "Unable to create directory for locale configuration file" << configPath;
+        return false;
+    }
+
+    QByteArray content;
+    if (!configPath.startsWith("/etc/"))
+        content += "# Autogenerated by settings\n";
+    content += QString("LANG=%1\n").arg(locale).toLatin1();
+
+    // Write next to the target, flush to disk and rename over it so that
+    // readers never see a partially written file.
+    const QByteArray path = QFile::encodeName(configPath);
+    QByteArray temporaryPath = path + ".XXXXXX";
+    int fd = mkostemp(temporaryPath.data(), O_CLOEXEC);
+    if (fd == -1) {
+        qWarning() << "Unable to create locale configuration file:" << configPath << ":" << strerror(errno);
+        return false;
+    }
+
+    if (fchown(fd, 0, 0) == -1) {
+        qWarning() << "Failed to set localeconfig as root:root:" << configPath << ":" << strerror(errno);
+    }
+
+    bool success = writeAll(fd, content)
+            && fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) == 0
+            && fsync(fd) == 0;
+    success = close(fd) == 0 && success;
+
+    if (!success || rename(temporaryPath.constData(), path.constData()) == -1) {
+        qWarning() << "Unable to write locale configuration file:" << configPath << ":" << strerror(errno);
+        unlink(temporaryPath.constData());
+        return false;
+    }
+
+    // Persist the rename itself
+    const QByteArray directoryPath = QFile::encodeName(QFileInfo(configPath).absolutePath());
+    int directoryFd = open(directoryPath.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd != -1) {
+        fsync(directoryFd);
+        close(directoryFd);
+    }
+
+    return true;
+}
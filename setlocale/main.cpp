@@ -31,80 +31,28 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
  */
 
-#include <QDir>
-#include <QFile>
-#include <QFileInfo>
-#include <QRegularExpression>
+#include <QCoreApplication>
 #include <QDebug>
 
 #include <stdlib.h>
-#include <unistd.h>
-#include <errno.h>
 #include <string.h>
-#include <sys/stat.h>
+#include <unistd.h>
 #include <sailfishaccesscontrol.h>
 
 #include "../src/localeconfig.h"
+#include "localewriter.h"
+#include "setlocaleservice.h"
 
-static bool ensureDirectory(QString filePath)
-{
-    auto directory = QFileInfo(filePath).dir();
-
-    if (directory.exists())
-        return true;
-
-    // Ensure parent with correct rights (recursion)
-    if (!ensureDirectory(directory.path()))
-        return false;
-
-    // Create this directory
-    if (!directory.mkpath(QStringLiteral(".")))
-        return false;
-
-    // Set correct access perms, root:root 755
-    auto pathArray = directory.path().toUtf8();
-    const char *path = pathArray.data();
-
-    if (chmod(path, S_IWUSR | S_IRUSR | S_IXUSR | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == -1)
-        qWarning() << "Failed to set directory permissions" << directory.path() << ":" << strerror(errno);
-
-    if (chown(path, 0, 0) == -1)
-        qWarning() << "Failed to set directory as root:root" << directory.path() << ":" << strerror(errno);
-
-    return true;
-}
-
-static bool writeLocale(QString &configPath, QString &locale)
+int main(int argc, char *argv[])
 {
-    QFile localeConfig(configPath);
-    if (!ensureDirectory(configPath)) {
-        qWarning() << "Unable to create directory for locale configuration file" << configPath;
-        return false;
-    }
-
-    if (!localeConfig.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
-        qWarning() << "Unable to open locale configuration file for writing:" << configPath
-                   << "-" << localeConfig.errorString();
-        return false;
-    }
-
-    localeConfig.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner |
-                                QFileDevice::ReadGroup | QFileDevice::ReadOther);
-
-    if (fchown(localeConfig.handle(), 0, 0) == -1) {
-        qWarning() << "Failed to set localeconfig as root:root:" << configPath << ":" << strerror(errno);
+    if (argc == 2 && strcmp(argv[1], "--service") == 0) {
+        QCoreApplication app(argc, argv);
+        SetLocaleService service;
+        if (!service.registerService())
+            return EXIT_FAILURE;
+        return app.exec();
     }
 
-    if (!configPath.startsWith("/etc/"))
-        localeConfig.write("# Autogenerated by settings\n");
-
-    localeConfig.write(QString("LANG=%1\n").arg(locale).toLatin1());
-    localeConfig.close();
-    return true;
-}
-
-int main(int argc, char *argv[])
-{
     if (argc != 2) {
         qWarning() << "No locale given";
         return EXIT_FAILURE;
@@ -122,8 +70,7 @@ int main(int argc, char *argv[])
     }
 
     QString newLocale = QString(argv[1]);
-    QRegularExpression allowedInput("^[a-zA-Z0-9\\.@_]*$");
-    if (!allowedInput.match(newLocale).hasMatch()) {
+    if (!isValidLocale(newLocale)) {
         qWarning() << "Invalid locale input:" << newLocale;
         return EXIT_FAILURE;
     }
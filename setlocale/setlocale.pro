@@ -3,16 +3,30 @@ TARGET = setlocale
 TARGETPATH = /usr/libexec
 target.path = $$TARGETPATH
 
-QT = core
+QT = core dbus
 
 CONFIG += link_pkgconfig
 PKGCONFIG += sailfishaccesscontrol
 
 SOURCES += \
     main.cpp \
+    localewriter.cpp \
+    setlocaleservice.cpp \
     ../src/localeconfig.cpp
 
 HEADERS += \
+    localewriter.h \
+    setlocaleservice.h \
     ../src/localeconfig.h
 
-INSTALLS += target
+dbusservice.files = org.nemomobile.systemsettings.setlocale.service
+dbusservice.path = /usr/share/dbus-1/system-services
+
+dbusconfig.files = org.nemomobile.systemsettings.setlocale.conf
+dbusconfig.path = /etc/dbus-1/system.d
+
+OTHER_FILES += \
+    $$dbusservice.files \
+    $$dbusconfig.files
+
+INSTALLS += target dbusservice dbusconfig
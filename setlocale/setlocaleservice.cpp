@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "setlocaleservice.h"
+#include "localewriter.h"
+#include "../src/localeconfig.h"
+
+#include <QCoreApplication>
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QDBusReply>
+#include <QDebug>
+#include <QFile>
+
+#include <grp.h>
+#include <pwd.h>
+#include <sailfishaccesscontrol.h>
+
+namespace {
+
+const auto ServiceName = QStringLiteral("org.nemomobile.systemsettings.setlocale");
+const auto ObjectPath = QStringLiteral("/");
+const int IdleTimeout = 30000;
+
+bool groupId(const char *groupName, gid_t *gid)
+{
+    const struct group *entry = getgrnam(groupName);
+    if (!entry)
+        return false;
+    *gid = entry->gr_gid;
+    return true;
+}
+
+// Fallback for bus daemons not reporting UnixGroupIDs. The pid can only be
+// reused once the caller has exited, and a process taking it over would have
+// to be privileged itself to pass. The locale written is still that of the
+// uid the bus reported, which privileged processes of it may change anyway.
+bool processHasGroup(uint pid, gid_t groupId)
+{
+    const QByteArray gid = QByteArray::number(groupId);
+
+    QFile status(QStringLiteral("/proc/%1/status").arg(pid));
+    if (!status.open(QIODevice::ReadOnly))
+        return false;
+
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("Gid:")) {
+            // Real, effective, saved and filesystem group ids
+            const QList<QByteArray> ids = line.mid(4).simplified().split(' ');
+            if (ids.value(1) == gid)
+                return true;
+        } else if (line.startsWith("Groups:")) {
+            if (line.mid(7).simplified().split(' ').contains(gid))
+                return true;
+        }
+    }
+    return false;
+}
+
+}
+
+SetLocaleService::SetLocaleService(QObject *parent)
+    : QObject(parent)
+{
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(IdleTimeout);
+    connect(&m_idleTimer, &QTimer::timeout, qApp, &QCoreApplication::quit);
+}
+
+bool SetLocaleService::registerService()
+{
+    QDBusConnection connection = QDBusConnection::systemBus();
+    if (!connection.registerObject(ObjectPath, this, QDBusConnection::ExportAllSlots)) {
+        qWarning() << "Unable to register locale service object:" << connection.lastError().message();
+        return false;
+    }
+    if (!connection.registerService(ServiceName)) {
+        qWarning() << "Unable to register locale service:" << connection.lastError().message();
+        return false;
+    }
+
+    m_idleTimer.start();
+    return true;
+}
+
+void SetLocaleService::SetLocale(const QString &user, const QString &system)
+{
+    m_idleTimer.start();
+
+    // The setlocale helper is only executable with the privileged group, so
+    // check the groups the caller connected with instead of the groups of its
+    // user, which sandboxed applications share. The bus policy applies the
+    // same restriction where the daemon knows the connection's groups.
+    const QDBusReply<QVariantMap> credentialsReply = connection().interface()->call(
+                QStringLiteral("GetConnectionCredentials"), message().service());
+    const QVariantMap credentials = credentialsReply.value();
+    if (!credentialsReply.isValid() || !credentials.contains(QStringLiteral("UnixUserID"))) {
+        sendErrorReply(QDBusError::AccessDenied, QStringLiteral("Unable to identify caller"));
+        return;
+    }
+    const uid_t uid = credentials.value(QStringLiteral("UnixUserID")).toUInt();
+
+    gid_t privilegedGroup;
+    bool privileged = false;
+    if (groupId("privileged", &privilegedGroup)) {
+        const auto groups = credentials.find(QStringLiteral("UnixGroupIDs"));
+        const auto pid = credentials.find(QStringLiteral("ProcessID"));
+        if (groups != credentials.end()) {
+            privileged = qdbus_cast<QList<uint>>(*groups).contains(privilegedGroup);
+        } else if (pid != credentials.end()) {
+            privileged = processHasGroup(pid->toUInt(), privilegedGroup);
+        }
+    }
+    if (!privileged) {
+        qWarning() << "Connection" << message().service() << "of user" << uid << "is not privileged";
+        sendErrorReply(QDBusError::AccessDenied, QStringLiteral("Caller is not privileged"));
+        return;
+    }
+
+    if (!sailfish_access_control_hasgroup(uid, "users")) {
+        qWarning() << "User with id" << uid << "is not member of users group";
+        sendErrorReply(QDBusError::AccessDenied, QStringLiteral("Caller is not member of users group"));
+        return;
+    }
+
+    if (!isValidLocale(user) || !isValidLocale(system)) {
+        qWarning() << "Invalid locale input:" << user << system;
+        sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("Invalid locale"));
+        return;
+    }
+
+    if (!user.isEmpty()) {
+        const struct passwd *entry = getpwuid(uid);
+        if (!entry || !entry->pw_dir) {
+            sendErrorReply(QDBusError::Failed, QStringLiteral("Unknown user"));
+            return;
+        }
+        if (!writeLocale(userLocaleConfigPath(QFile::decodeName(entry->pw_dir)), user)) {
+            sendErrorReply(QDBusError::Failed, QStringLiteral("Unable to write user locale"));
+            return;
+        }
+    }
+
+    // Set system locale as well if the user is device owner
+    if (!system.isEmpty() && sailfish_access_control_hasgroup(uid, "sailfish-system")) {
+        if (!writeLocale(systemLocaleConfigPath(), system)) {
+            sendErrorReply(QDBusError::Failed, QStringLiteral("Unable to write system locale"));
+            return;
+        }
+    }
+}
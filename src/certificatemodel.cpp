@@ -31,6 +31,7 @@
  */
 
 #include "certificatemodel.h"
+#include "collationcache_p.h"
 
 #include <QFile>
 #include <QRegularExpression>
@@ -766,13 +767,14 @@ void CertificateModel::refresh()
         m_certificates.clear();
     } else {
         m_certificates = getCertificates(m_path);
-        std::stable_sort(m_certificates.begin(), m_certificates.end(), [](const Certificate &lhs, const Certificate &rhs) {
-            int c = lhs.primaryName().compare(rhs.primaryName(), Qt::CaseInsensitive);
+        CollationCache *collation = CollationCache::instance(Qt::CaseInsensitive);
+        std::stable_sort(m_certificates.begin(), m_certificates.end(), [collation](const Certificate &lhs, const Certificate &rhs) {
+            int c = collation->compare(lhs.primaryName(), rhs.primaryName());
             if (c < 0)
                 return true;
             if (c > 0)
                 return false;
-            c = lhs.secondaryName().compare(rhs.secondaryName(), Qt::CaseInsensitive);
+            c = collation->compare(lhs.secondaryName(), rhs.secondaryName());
             if (c < 0)
                 return true;
             return false;
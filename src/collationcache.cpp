@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "collationcache_p.h"
+
+namespace {
+
+// Bounds the cache for long lived processes, it is refilled on demand.
+const int MaximumSortKeys = 4096;
+
+}
+
+CollationCache *CollationCache::instance(Qt::CaseSensitivity caseSensitivity)
+{
+    static CollationCache caseSensitive(Qt::CaseSensitive);
+    static CollationCache caseInsensitive(Qt::CaseInsensitive);
+
+    CollationCache *cache = caseSensitivity == Qt::CaseSensitive ? &caseSensitive : &caseInsensitive;
+    cache->ensureLocale();
+    return cache;
+}
+
+CollationCache::CollationCache(Qt::CaseSensitivity caseSensitivity)
+{
+    m_collator.setCaseSensitivity(caseSensitivity);
+}
+
+void CollationCache::ensureLocale()
+{
+    const QLocale locale;
+    if (locale != m_locale) {
+        m_locale = locale;
+        m_collator.setLocale(locale);
+        m_sortKeys.clear();
+    }
+}
+
+int CollationCache::compare(const QString &left, const QString &right)
+{
+    if (left == right) {
+        return 0;
+    }
+    return sortKey(left).compare(sortKey(right));
+}
+
+QCollatorSortKey CollationCache::sortKey(const QString &string)
+{
+    auto it = m_sortKeys.constFind(string);
+    if (it == m_sortKeys.constEnd()) {
+        if (m_sortKeys.count() >= MaximumSortKeys) {
+            m_sortKeys.clear();
+        }
+        it = m_sortKeys.insert(string, m_collator.sortKey(string));
+    }
+    return *it;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef COLLATIONCACHE_P_H
+#define COLLATIONCACHE_P_H
+
+#include <QCollator>
+#include <QHash>
+#include <QLocale>
+
+// Collation sort keys of display strings, computed once per string so that
+// sorting compares keys instead of collating both strings on every call.
+// The cache is dropped when the default locale changes. GUI thread only.
+class CollationCache
+{
+public:
+    static CollationCache *instance(Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive);
+
+    int compare(const QString &left, const QString &right);
+    bool lessThan(const QString &left, const QString &right) { return compare(left, right) < 0; }
+
+private:
+    explicit CollationCache(Qt::CaseSensitivity caseSensitivity);
+
+    void ensureLocale();
+    QCollatorSortKey sortKey(const QString &string);
+
+    QLocale m_locale;
+    QCollator m_collator;
+    QHash<QString, QCollatorSortKey> m_sortKeys;
+};
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "dbuscallstatistics_p.h"
+#include "logging_p.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QSocketNotifier>
+#include <QStringList>
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+const char * const SignalEnvironmentVariable = "SYSTEMSETTINGS_DBUS_STATISTICS_SIGNAL";
+
+}
+
+int DBusCallStatistics::signalFd[2] = { -1, -1 };
+
+DBusCallStatistics *DBusCallStatistics::instance()
+{
+    static QPointer<DBusCallStatistics> sharedInstance;
+    if (!sharedInstance) {
+        sharedInstance = new DBusCallStatistics(QCoreApplication::instance());
+    }
+    return sharedInstance;
+}
+
+DBusCallStatistics::DBusCallStatistics(QObject *parent)
+    : QObject(parent)
+    , m_signalNotifier(nullptr)
+{
+    // A library should not take a process wide signal over by default.
+    if (qEnvironmentVariableIsSet(SignalEnvironmentVariable)) {
+        installSignalHandler();
+    }
+}
+
+DBusCallStatistics::~DBusCallStatistics()
+{
+    if (m_signalNotifier) {
+        ::signal(SIGUSR1, SIG_DFL);
+        ::close(signalFd[0]);
+        ::close(signalFd[1]);
+        signalFd[0] = signalFd[1] = -1;
+    }
+}
+
+void DBusCallStatistics::record(const QString &interface, const QString &method, qint64 nsecs, bool success)
+{
+    int bucket = 0;
+    for (qint64 msecs = nsecs / 1000000; msecs > 0 && bucket < BucketCount - 1; msecs >>= 1) {
+        ++bucket;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    Entry &entry = m_entries[interface + QLatin1Char('.') + method];
+    ++entry.calls;
+    if (!success) {
+        ++entry.errors;
+    }
+    entry.totalNsecs += nsecs;
+    entry.maximumNsecs = qMax(entry.maximumNsecs, nsecs);
+    ++entry.buckets[bucket];
+}
+
+QVariantMap DBusCallStatistics::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVariantMap statistics;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        QVariantList histogram;
+        for (quint64 count : it->buckets) {
+            histogram.append(count);
+        }
+
+        QVariantMap entry;
+        entry.insert(QStringLiteral("calls"), it->calls);
+        entry.insert(QStringLiteral("errors"), it->errors);
+        entry.insert(QStringLiteral("averageLatency"), it->calls > 0 ? qreal(it->totalNsecs) / it->calls / 1e6 : 0);
+        entry.insert(QStringLiteral("maximumLatency"), qreal(it->maximumNsecs) / 1e6);
+        entry.insert(QStringLiteral("histogram"), histogram);
+        statistics.insert(it.key(), entry);
+    }
+    return statistics;
+}
+
+void DBusCallStatistics::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+void DBusCallStatistics::dump() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QStringList keys = m_entries.keys();
+    keys.sort();
+
+    qCInfo(lcMemoryCardDBusLog) << "D-Bus calls, latencies in ms, histogram buckets <1 <2 <4 ... <8192 >=8192";
+    for (const QString &key : keys) {
+        const Entry &entry = m_entries[key];
+        QStringList histogram;
+        for (quint64 count : entry.buckets) {
+            histogram.append(QString::number(count));
+        }
+        qCInfo(lcMemoryCardDBusLog, "%s calls: %llu errors: %llu average: %.2f maximum: %.2f histogram: %s",
+               qPrintable(key), entry.calls, entry.errors,
+               entry.calls > 0 ? qreal(entry.totalNsecs) / entry.calls / 1e6 : 0.0,
+               qreal(entry.maximumNsecs) / 1e6,
+               qPrintable(histogram.join(QLatin1Char(' '))));
+    }
+}
+
+void DBusCallStatistics::installSignalHandler()
+{
+    // Never take SIGUSR1 over from an application that uses it.
+    struct sigaction previous;
+    if (::sigaction(SIGUSR1, nullptr, &previous) != 0 || previous.sa_handler != SIG_DFL) {
+        return;
+    }
+
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, signalFd) != 0) {
+        qCWarning(lcMemoryCardDBusLog) << "Unable to create SIGUSR1 socket pair";
+        return;
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = &DBusCallStatistics::handleSignal;
+    ::sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (::sigaction(SIGUSR1, &action, nullptr) != 0) {
+        ::close(signalFd[0]);
+        ::close(signalFd[1]);
+        signalFd[0] = signalFd[1] = -1;
+        return;
+    }
+
+    m_signalNotifier = new QSocketNotifier(signalFd[1], QSocketNotifier::Read, this);
+    connect(m_signalNotifier, &QSocketNotifier::activated, this, &DBusCallStatistics::signalReceived);
+}
+
+// Only async-signal-safe work here, the dump happens in the event loop.
+void DBusCallStatistics::handleSignal(int)
+{
+    const char byte = 1;
+    ssize_t written = ::write(signalFd[0], &byte, sizeof(byte));
+    Q_UNUSED(written)
+}
+
+void DBusCallStatistics::signalReceived()
+{
+    char byte;
+    ssize_t bytesRead = ::read(signalFd[1], &byte, sizeof(byte));
+    Q_UNUSED(bytesRead)
+
+    dump();
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef DBUSCALLSTATISTICS_P_H
+#define DBUSCALLSTATISTICS_P_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QVariantMap>
+
+class QSocketNotifier;
+
+// Counts and latency histograms of the D-Bus calls made by the memory card
+// stack, keyed by interface and method. With
+// SYSTEMSETTINGS_DBUS_STATISTICS_SIGNAL set in the environment the
+// statistics are dumped to lcMemoryCardDBusLog on SIGUSR1, unless the
+// application handles the signal itself.
+class DBusCallStatistics : public QObject
+{
+    Q_OBJECT
+
+public:
+    static DBusCallStatistics *instance();
+
+    // Latency buckets are powers of two in milliseconds: <1, <2, <4 ... <8192, and above.
+    static const int BucketCount = 15;
+
+    void record(const QString &interface, const QString &method, qint64 nsecs, bool success);
+
+    QVariantMap statistics() const;
+    void reset();
+    void dump() const;
+
+private:
+    struct Entry
+    {
+        quint64 calls = 0;
+        quint64 errors = 0;
+        qint64 totalNsecs = 0;
+        qint64 maximumNsecs = 0;
+        quint64 buckets[BucketCount] = {};
+    };
+
+    explicit DBusCallStatistics(QObject *parent = nullptr);
+    ~DBusCallStatistics();
+
+    void installSignalHandler();
+    void signalReceived();
+
+    static void handleSignal(int signal);
+    static int signalFd[2];
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    QSocketNotifier *m_signalNotifier;
+};
+
+#endif
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "filesystemcapabilities_p.h"
+#include "udisks2defines.h"
+#include "logging_p.h"
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusInterface>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <nemo-dbus/dbus.h>
+
+namespace {
+const auto mkfsDirectory = QStringLiteral("/sbin/");
+}
+
+QPointer<FileSystemCapabilities> FileSystemCapabilities::sharedInstance = nullptr;
+
+FileSystemCapabilities *FileSystemCapabilities::instance()
+{
+    return sharedInstance ? sharedInstance.data() : new FileSystemCapabilities;
+}
+
+FileSystemCapabilities::FileSystemCapabilities(QObject *parent)
+    : QObject(parent)
+    , m_fileSystemsValid(false)
+    , m_formatTypesValid(false)
+{
+    Q_ASSERT(!sharedInstance);
+    sharedInstance = this;
+
+    // Installing or removing a package providing a mkfs helper changes /sbin.
+    m_watcher.addPath(mkfsDirectory);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        invalidateFormatTypes();
+        queryUDisks();
+    });
+
+    queryUDisks();
+}
+
+FileSystemCapabilities::~FileSystemCapabilities()
+{
+    sharedInstance = nullptr;
+}
+
+QStringList FileSystemCapabilities::supportedFileSystems()
+{
+    if (!m_fileSystemsValid) {
+        readFileSystems();
+    }
+    return m_fileSystems;
+}
+
+bool FileSystemCapabilities::isSupportedFileSystem(const QString &filesystemType)
+{
+    if (!m_fileSystemsValid) {
+        readFileSystems();
+    }
+    return m_fileSystemSet.contains(filesystemType);
+}
+
+QStringList FileSystemCapabilities::formatTypes()
+{
+    if (!m_formatTypesValid) {
+        readFormatTypes();
+    }
+    return m_formatTypes;
+}
+
+void FileSystemCapabilities::invalidateFileSystems()
+{
+    m_fileSystemsValid = false;
+}
+
+void FileSystemCapabilities::invalidateFormatTypes()
+{
+    if (m_formatTypesValid) {
+        m_formatTypesValid = false;
+        emit formatTypesChanged();
+    }
+}
+
+void FileSystemCapabilities::readFileSystems()
+{
+    // Query filesystems supported by this device
+    // Note this will only find filesystems supported either directly by the
+    // kernel, or by modules already loaded.
+    m_fileSystems.clear();
+    QFile filesystems(QStringLiteral("/proc/filesystems"));
+    if (filesystems.open(QIODevice::ReadOnly)) {
+        QString line = filesystems.readLine();
+        while (line.length() > 0) {
+            m_fileSystems << line.trimmed().split('\t').last();
+            line = filesystems.readLine();
+        }
+    }
+
+    // UDisks2 may be able to mount file systems whose modules are not loaded yet.
+    for (const QString &filesystemType : m_udisksFileSystems) {
+        if (!m_fileSystems.contains(filesystemType)) {
+            m_fileSystems << filesystemType;
+        }
+    }
+
+    m_fileSystemSet = QSet<QString>(m_fileSystems.constBegin(), m_fileSystems.constEnd());
+    m_fileSystemsValid = true;
+}
+
+void FileSystemCapabilities::readFormatTypes()
+{
+    m_mkfsTypes.clear();
+    QDir dir(mkfsDirectory);
+    QStringList entries = dir.entryList(QStringList() << QString("mkfs.*"));
+    for (const QString &entry : entries) {
+        QFileInfo info(mkfsDirectory + entry);
+        if (info.exists() && info.isExecutable()) {
+            QStringList parts = entry.split('.');
+            if (!parts.isEmpty()) {
+                m_mkfsTypes << parts.takeLast();
+            }
+        }
+    }
+
+    // Filter out the types UDisks2 says it cannot format, unknown ones are kept.
+    m_formatTypes.clear();
+    for (const QString &type : m_mkfsTypes) {
+        if (m_udisksCanFormat.value(type, true)) {
+            m_formatTypes << type;
+        }
+    }
+    m_formatTypesValid = true;
+}
+
+void FileSystemCapabilities::queryUDisks()
+{
+    QDBusInterface propertiesInterface(UDISKS2_SERVICE,
+                                       UDISKS2_MANAGER_PATH,
+                                       DBUS_OBJECT_PROPERTIES_INTERFACE,
+                                       QDBusConnection::systemBus());
+    QDBusPendingCall pendingCall = propertiesInterface.asyncCall(DBUS_GET_ALL, UDISKS2_MANAGER_INTERFACE);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        QDBusPendingReply<QVariantMap> reply = *watcher;
+        if (reply.isError()) {
+            qCWarning(lcMemoryCardLog) << "Unable to read UDisks2 manager properties:" << reply.error().message();
+        } else {
+            const QVariantMap properties = NemoDBus::demarshallArgument<QVariantMap>(reply.value());
+            const QStringList filesystems = NemoDBus::demarshallDBusArgument(
+                        properties.value(QStringLiteral("SupportedFilesystems"))).toStringList();
+            const QSet<QString> udisksFileSystems(filesystems.constBegin(), filesystems.constEnd());
+            if (m_udisksFileSystems != udisksFileSystems) {
+                m_udisksFileSystems = udisksFileSystems;
+                invalidateFileSystems();
+                emit fileSystemsChanged();
+            }
+        }
+        watcher->deleteLater();
+    });
+
+    if (!m_formatTypesValid) {
+        readFormatTypes();
+    }
+
+    QDBusInterface managerInterface(UDISKS2_SERVICE,
+                                    UDISKS2_MANAGER_PATH,
+                                    UDISKS2_MANAGER_INTERFACE,
+                                    QDBusConnection::systemBus());
+    for (const QString &type : m_mkfsTypes) {
+        QDBusPendingCall pendingCall = managerInterface.asyncCall(QStringLiteral("CanFormat"), type);
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, type](QDBusPendingCallWatcher *watcher) {
+            QDBusPendingReply<> reply = *watcher;
+            if (!reply.isError()) {
+                // CanFormat returns (b available, s missing utility).
+                const QDBusArgument result = reply.argumentAt(0).value<QDBusArgument>();
+                bool available = true;
+                QString missingUtility;
+                result.beginStructure();
+                result >> available >> missingUtility;
+                result.endStructure();
+
+                if (!available) {
+                    qCInfo(lcMemoryCardLog) << "Cannot format" << type << "missing" << missingUtility;
+                }
+
+                if (m_udisksCanFormat.value(type, true) != available) {
+                    m_udisksCanFormat.insert(type, available);
+                    invalidateFormatTypes();
+                }
+            }
+            watcher->deleteLater();
+        });
+    }
+}
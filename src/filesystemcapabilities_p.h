@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef FILESYSTEMCAPABILITIES_P_H
+#define FILESYSTEMCAPABILITIES_P_H
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+
+// Process wide cache of the file systems this device can mount and format.
+// Combines /proc/filesystems, the mkfs helpers in /sbin and what UDisks2
+// reports through Manager.SupportedFilesystems and Manager.CanFormat.
+class FileSystemCapabilities : public QObject
+{
+    Q_OBJECT
+public:
+    static FileSystemCapabilities *instance();
+    ~FileSystemCapabilities();
+
+    QStringList supportedFileSystems();
+    bool isSupportedFileSystem(const QString &filesystemType);
+
+    QStringList formatTypes();
+
+    void invalidateFileSystems();
+    void invalidateFormatTypes();
+
+signals:
+    // Emitted when UDisks2 reports a different set of supported file systems.
+    void fileSystemsChanged();
+    void formatTypesChanged();
+
+private:
+    explicit FileSystemCapabilities(QObject *parent = nullptr);
+
+    void readFileSystems();
+    void readFormatTypes();
+    void queryUDisks();
+
+    QStringList m_fileSystems;
+    QSet<QString> m_fileSystemSet;
+    bool m_fileSystemsValid;
+
+    QStringList m_mkfsTypes;
+    QStringList m_formatTypes;
+    bool m_formatTypesValid;
+
+    // Empty until UDisks2 has answered.
+    QSet<QString> m_udisksFileSystems;
+    QHash<QString, bool> m_udisksCanFormat;
+
+    QFileSystemWatcher m_watcher;
+
+    static QPointer<FileSystemCapabilities> sharedInstance;
+};
+
+#endif
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "iostatistics_p.h"
+#include "logging_p.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QTimer>
+
+static const int SectorSize = 512;
+
+IoStatisticsWorker::IoStatisticsWorker(QObject *parent)
+    : QObject(parent)
+    , m_timer(nullptr)
+{
+}
+
+IoStatisticsWorker::~IoStatisticsWorker()
+{
+}
+
+void IoStatisticsWorker::setDevices(const QStringList &devicePaths)
+{
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        m_timer->setInterval(IoStatisticsSampler::Interval);
+        connect(m_timer, &QTimer::timeout, this, &IoStatisticsWorker::sample);
+    }
+
+    m_devicePaths = devicePaths;
+    m_statPaths.clear();
+    for (const QString &devicePath : devicePaths) {
+        const QString path = statPath(devicePath);
+        if (!QFile::exists(path)) {
+            qCWarning(lcMemoryCardLog) << "No block statistics for" << devicePath << "at" << path;
+        }
+        m_statPaths.insert(devicePath, path);
+    }
+
+    for (auto it = m_counters.begin(); it != m_counters.end();) {
+        if (devicePaths.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_counters.erase(it);
+        }
+    }
+
+    if (m_devicePaths.isEmpty()) {
+        m_timer->stop();
+    } else if (!m_timer->isActive()) {
+        // Take the baseline now, rates are reported from the next sample on.
+        sample();
+        m_timer->start();
+    }
+}
+
+QString IoStatisticsWorker::statPath(const QString &devicePath)
+{
+    // Mapper and LVM device nodes are symlinks to their dm-N node, which is
+    // the name the kernel uses.
+    const QString canonicalPath = QFileInfo(devicePath).canonicalFilePath();
+    const QString name = QFileInfo(canonicalPath.isEmpty() ? devicePath : canonicalPath).fileName();
+
+    // Works for both whole disks and partitions, unlike /sys/block.
+    return QStringLiteral("/sys/class/block/%1/stat").arg(name);
+}
+
+bool IoStatisticsWorker::readCounters(const QString &path, Counters *counters)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QList<QByteArray> fields = file.readAll().simplified().split(' ');
+    if (fields.count() < 8) {
+        return false;
+    }
+
+    // Fields: read I/Os, read merges, read sectors, read ticks,
+    //         write I/Os, write merges, write sectors, write ticks, ...
+    counters->readOperations = fields.at(0).toULongLong();
+    counters->readSectors = fields.at(2).toULongLong();
+    counters->readTicks = fields.at(3).toULongLong();
+    counters->writeOperations = fields.at(4).toULongLong();
+    counters->writeSectors = fields.at(6).toULongLong();
+    counters->writeTicks = fields.at(7).toULongLong();
+    return true;
+}
+
+void IoStatisticsWorker::sample()
+{
+    const qint64 elapsed = m_elapsed.isValid() ? m_elapsed.restart() : 0;
+    if (!m_elapsed.isValid()) {
+        m_elapsed.start();
+    }
+
+    IoStatisticsHash statistics;
+    for (const QString &devicePath : m_devicePaths) {
+        Counters counters;
+        if (!readCounters(m_statPaths.value(devicePath), &counters)) {
+            // The mapping may have been recreated under another dm-N node.
+            m_statPaths.insert(devicePath, statPath(devicePath));
+            m_counters.remove(devicePath);
+            continue;
+        }
+
+        auto previous = m_counters.find(devicePath);
+        if (previous != m_counters.end() && elapsed > 0) {
+            const quint64 operations = (counters.readOperations - previous->readOperations)
+                    + (counters.writeOperations - previous->writeOperations);
+            const quint64 ticks = (counters.readTicks - previous->readTicks)
+                    + (counters.writeTicks - previous->writeTicks);
+
+            IoStatistics &entry = statistics[devicePath];
+            entry.readBytesPerSecond = (counters.readSectors - previous->readSectors) * SectorSize * 1000 / elapsed;
+            entry.writeBytesPerSecond = (counters.writeSectors - previous->writeSectors) * SectorSize * 1000 / elapsed;
+            entry.operationsPerSecond = qreal(operations) * 1000 / elapsed;
+            entry.averageLatency = operations > 0 ? qreal(ticks) / operations : 0;
+        }
+        m_counters.insert(devicePath, counters);
+    }
+
+    emit sampled(statistics);
+}
+
+IoStatisticsSampler::IoStatisticsSampler(QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread())
+    , m_worker(new IoStatisticsWorker())
+{
+    qRegisterMetaType<IoStatisticsHash>("IoStatisticsHash");
+
+    m_worker->moveToThread(m_thread);
+
+    connect(this, &IoStatisticsSampler::devicesChanged, m_worker, &IoStatisticsWorker::setDevices);
+    connect(m_worker, &IoStatisticsWorker::sampled, this, &IoStatisticsSampler::sampled);
+
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+
+    m_thread->start();
+}
+
+IoStatisticsSampler::~IoStatisticsSampler()
+{
+    m_thread->quit();
+}
+
+void IoStatisticsSampler::setDevices(const QStringList &devicePaths)
+{
+    if (m_devicePaths != devicePaths) {
+        m_devicePaths = devicePaths;
+        emit devicesChanged(devicePaths);
+    }
+}
+
+IoStatistics IoStatisticsSampler::statistics(const QString &devicePath) const
+{
+    return m_statistics.value(devicePath);
+}
+
+void IoStatisticsSampler::sampled(const IoStatisticsHash &statistics)
+{
+    m_statistics = statistics;
+    emit updated();
+}
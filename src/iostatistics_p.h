@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef IOSTATISTICS_P_H
+#define IOSTATISTICS_P_H
+
+#include <QObject>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QStringList>
+
+class QThread;
+class QTimer;
+
+struct IoStatistics
+{
+    qint64 readBytesPerSecond = 0;
+    qint64 writeBytesPerSecond = 0;
+    qreal operationsPerSecond = 0;
+    qreal averageLatency = 0;   // milliseconds per completed operation
+};
+
+typedef QHash<QString, IoStatistics> IoStatisticsHash;
+
+Q_DECLARE_METATYPE(IoStatistics)
+Q_DECLARE_METATYPE(IoStatisticsHash)
+
+// Reads the block layer counters of /sys/class/block/<name>/stat.
+class IoStatisticsWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IoStatisticsWorker(QObject *parent = 0);
+    ~IoStatisticsWorker();
+
+public slots:
+    void setDevices(const QStringList &devicePaths);
+    void sample();
+
+signals:
+    void sampled(const IoStatisticsHash &statistics);
+
+private:
+    struct Counters
+    {
+        quint64 readOperations = 0;
+        quint64 readSectors = 0;
+        quint64 readTicks = 0;
+        quint64 writeOperations = 0;
+        quint64 writeSectors = 0;
+        quint64 writeTicks = 0;
+    };
+
+    static QString statPath(const QString &devicePath);
+    static bool readCounters(const QString &path, Counters *counters);
+
+    QTimer *m_timer;
+    QElapsedTimer m_elapsed;
+    QStringList m_devicePaths;
+    QHash<QString, QString> m_statPaths;
+    QHash<QString, Counters> m_counters;
+};
+
+// Samples the I/O statistics of a set of block devices on a worker thread
+// for as long as it exists.
+class IoStatisticsSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IoStatisticsSampler(QObject *parent = 0);
+    ~IoStatisticsSampler();
+
+    static const int Interval = 1000;
+
+    void setDevices(const QStringList &devicePaths);
+    IoStatistics statistics(const QString &devicePath) const;
+
+signals:
+    void updated();
+    void devicesChanged(const QStringList &devicePaths);
+
+private:
+    void sampled(const IoStatisticsHash &statistics);
+
+    QThread *m_thread;
+    IoStatisticsWorker *m_worker;
+    QStringList m_devicePaths;
+    IoStatisticsHash m_statistics;
+};
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "languagecatalogue_p.h"
+#include "collationcache_p.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QPointer>
+#include <QSettings>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace {
+
+const char * const LanguageSupportDirectory = "/usr/share/supported-languages";
+
+}
+
+LanguageCatalogue *LanguageCatalogue::instance()
+{
+    static QPointer<LanguageCatalogue> sharedInstance;
+    if (!sharedInstance) {
+        // Without an application the instance is never destroyed.
+        sharedInstance = new LanguageCatalogue(QCoreApplication::instance());
+    }
+    return sharedInstance;
+}
+
+LanguageCatalogue::LanguageCatalogue(QObject *parent)
+    : QObject(parent)
+    , m_reloadPending(false)
+{
+    m_watcher.addPath(QString::fromLatin1(LanguageSupportDirectory));
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &LanguageCatalogue::reloadLater);
+
+    reload();
+}
+
+QList<Language> LanguageCatalogue::languages()
+{
+    checkLocale();
+    return m_languages;
+}
+
+int LanguageCatalogue::indexOf(const QString &localeCode)
+{
+    checkLocale();
+    return m_indexes.value(localeCode, -1);
+}
+
+void LanguageCatalogue::checkLocale()
+{
+    if (m_sortLocale != QLocale()) {
+        sort();
+        // Queued, as this may run while a model is reading the list.
+        QTimer::singleShot(0, this, &LanguageCatalogue::languagesChanged);
+    }
+}
+
+// Coalesces the notifications for a directory being updated file by file.
+void LanguageCatalogue::reloadLater()
+{
+    if (!m_reloadPending) {
+        m_reloadPending = true;
+        QTimer::singleShot(0, this, [this] {
+            m_reloadPending = false;
+            reload();
+            emit languagesChanged();
+        });
+    }
+}
+
+void LanguageCatalogue::reload()
+{
+    QDir languageDirectory(LanguageSupportDirectory);
+    QFileInfoList fileInfoList = languageDirectory.entryInfoList(QStringList("*.conf"), QDir::Files);
+    QList<Language> languages;
+
+    foreach (const QFileInfo &fileInfo, fileInfoList) {
+        QSettings settings(fileInfo.filePath(), QSettings::IniFormat);
+        settings.setIniCodec("UTF-8");
+        QString name = settings.value("Name").toString();
+        QString localeCode = settings.value("LocaleCode").toString();
+        QString region = settings.value("Region").toString();
+        // Translated by Language::regionLabel() when not set.
+        QString regionLabel = settings.value("RegionLabel").toString();
+        if (name.isEmpty() || localeCode.isEmpty()) {
+            continue;
+        }
+        Language newLanguage(name, localeCode, region, regionLabel);
+        languages.append(newLanguage);
+    }
+
+    m_languages = languages;
+    sort();
+}
+
+void LanguageCatalogue::sort()
+{
+    m_sortLocale = QLocale();
+
+    CollationCache *collation = CollationCache::instance();
+    std::sort(m_languages.begin(), m_languages.end(), [collation](const Language &lang1, const Language &lang2) {
+        return collation->lessThan(lang1.name(), lang2.name());
+    });
+
+    m_indexes.clear();
+    m_indexes.reserve(m_languages.count());
+    for (int i = 0; i < m_languages.count(); ++i) {
+        // The first entry wins if two files declare the same locale.
+        if (!m_indexes.contains(m_languages.at(i).localeCode())) {
+            m_indexes.insert(m_languages.at(i).localeCode(), i);
+        }
+    }
+}
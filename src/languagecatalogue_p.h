@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef LANGUAGECATALOGUE_P_H
+#define LANGUAGECATALOGUE_P_H
+
+#include "languagemodel.h"
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QLocale>
+
+// The supported languages of the process, parsed once and reloaded when
+// the supported-languages directory changes. The list is re-sorted the
+// next time it is read after the default locale has changed.
+class LanguageCatalogue : public QObject
+{
+    Q_OBJECT
+
+public:
+    static LanguageCatalogue *instance();
+
+    QList<Language> languages();
+    int indexOf(const QString &localeCode);
+
+    void checkLocale();
+
+signals:
+    void languagesChanged();
+
+private:
+    explicit LanguageCatalogue(QObject *parent = nullptr);
+
+    void reload();
+    void reloadLater();
+    void sort();
+
+    QFileSystemWatcher m_watcher;
+    QList<Language> m_languages;
+    QHash<QString, int> m_indexes;
+    QLocale m_sortLocale;
+    bool m_reloadPending;
+};
+
+#endif
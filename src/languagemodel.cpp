@@ -30,25 +30,20 @@
  */
 
 #include "languagemodel.h"
+#include "languagecatalogue_p.h"
 #include "localeconfig.h"
 
-#include <QDir>
 #include <QDebug>
-#include <QSettings>
-#include <QHash>
+#include <QFile>
 #include <QProcess>
+#include <QTimer>
 
 #include <nemo-dbus/connection.h>
 #include <nemo-dbus/interface.h>
 
 namespace {
-const char * const LanguageSupportDirectory = "/usr/share/supported-languages";
-
-bool nameLessThan(const Language &lang1, const Language &lang2)
-{
-    return (lang1.name().localeAwareCompare(lang2.name()) <= 0);
-}
-
+const auto SetLocaleService = QStringLiteral("org.nemomobile.systemsettings.setlocale");
+const auto SetLocaleServiceFile = QStringLiteral("/usr/share/dbus-1/system-services/org.nemomobile.systemsettings.setlocale.service");
 }
 
 
@@ -74,14 +69,33 @@ QString Language::region() const
 
 QString Language::regionLabel() const
 {
+    if (m_regionLabel.isEmpty()) {
+        // Translated on access so that it follows the current translators.
+        //% "Region: %1"
+        return qtTrId("systemsettings-la-region");
+    }
     return m_regionLabel;
 }
 
 LanguageModel::LanguageModel(QObject *parent)
     : QAbstractListModel(parent),
-      m_currentIndex(-1)
+      m_currentIndex(-1),
+      m_busy(false)
 {
-    m_languages = supportedLanguages();
+    LanguageCatalogue *catalogue = LanguageCatalogue::instance();
+    connect(catalogue, &LanguageCatalogue::languagesChanged, this, [this, catalogue] {
+        const int oldIndex = m_currentIndex;
+        beginResetModel();
+        m_languages = catalogue->languages();
+        m_currentIndex = -1;
+        readCurrentLocale();
+        endResetModel();
+        if (m_currentIndex != oldIndex) {
+            emit currentIndexChanged();
+        }
+    });
+
+    m_languages = catalogue->languages();
     readCurrentLocale();
 }
 
@@ -163,6 +177,11 @@ int LanguageModel::currentIndex() const
     return m_currentIndex;
 }
 
+bool LanguageModel::busy() const
+{
+    return m_busy;
+}
+
 QString LanguageModel::languageName(int index) const
 {
     if (index < 0 || index >= m_languages.count()) {
@@ -180,6 +199,42 @@ QString LanguageModel::locale(int index) const
 }
 
 void LanguageModel::setSystemLocale(const QString &localeCode, LocaleUpdateMode updateMode)
+{
+    if (m_busy) {
+        qWarning() << "Locale update already in progress, ignoring" << localeCode;
+        emit setSystemLocaleFinished(localeCode, BusyError);
+        return;
+    }
+
+    m_busy = true;
+    emit busyChanged();
+
+    // Prefer the activatable service, it avoids starting the helper for every change.
+    if (!QFile::exists(SetLocaleServiceFile)) {
+        runLocaleHelper(localeCode, updateMode);
+        return;
+    }
+
+    NemoDBus::Interface setLocaleInterface(
+            this, QDBusConnection::systemBus(),
+            SetLocaleService, "/", SetLocaleService);
+    NemoDBus::Response *response = setLocaleInterface.call("SetLocale", localeCode, localeCode);
+    response->onFinished([this, localeCode, updateMode]() {
+        localeUpdated(localeCode, updateMode);
+    });
+    response->onError([this, localeCode, updateMode](const QDBusError &error) {
+        if (error.type() == QDBusError::ServiceUnknown || error.type() == QDBusError::UnknownObject
+                || error.type() == QDBusError::UnknownMethod) {
+            qWarning() << "Locale service not available, using helper:" << error.message();
+            runLocaleHelper(localeCode, updateMode);
+        } else {
+            qWarning() << "Setting user locale failed:" << error.name() << error.message();
+            finishLocaleUpdate(localeCode, HelperFailedError);
+        }
+    });
+}
+
+void LanguageModel::runLocaleHelper(const QString &localeCode, LocaleUpdateMode updateMode)
 {
     QLatin1String exec;
 //FOR SFOS
@@ -193,16 +248,37 @@ void LanguageModel::setSystemLocale(const QString &localeCode, LocaleUpdateMode
 
     if(exec.isEmpty()) {
         qWarning() << "Set local executable not found";
+        finishLocaleUpdate(localeCode, HelperNotFoundError);
         return;
     }
 
-    int ret = QProcess::execute(exec, QStringList(localeCode));
+    QProcess *process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::ForwardedChannels);
+    connect(process, &QProcess::errorOccurred, this, [this, process, localeCode](QProcess::ProcessError error) {
+        // Other errors are followed by finished()
+        if (error == QProcess::FailedToStart) {
+            qWarning() << "Setting user locale failed:" << process->errorString();
+            process->deleteLater();
+            finishLocaleUpdate(localeCode, HelperFailedError);
+        }
+    });
+    connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, [this, process, localeCode, updateMode](int exitCode, QProcess::ExitStatus exitStatus) {
+        process->deleteLater();
+
+        if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+            qWarning() << "Setting user locale failed!";
+            finishLocaleUpdate(localeCode, HelperFailedError);
+        } else {
+            localeUpdated(localeCode, updateMode);
+        }
+    });
 
-    if (ret != 0) {
-        qWarning() << "Setting user locale failed!";
-        return;
-    }
+    process->start(exec, QStringList(localeCode));
+}
 
+void LanguageModel::localeUpdated(const QString &localeCode, LocaleUpdateMode updateMode)
+{
     int oldLocale = m_currentIndex;
     m_currentIndex = getLocaleIndex(localeCode);
     if (m_currentIndex != oldLocale) {
@@ -213,45 +289,34 @@ void LanguageModel::setSystemLocale(const QString &localeCode, LocaleUpdateMode
         NemoDBus::Interface dsmeInterface(
                 this, QDBusConnection::systemBus(),
                 "com.nokia.dsme", "/com/nokia/dsme/request", "com.nokia.dsme.request");
-        dsmeInterface.blockingCall("req_reboot");
+        NemoDBus::Response *response = dsmeInterface.call("req_reboot");
+        response->onFinished([this, localeCode]() {
+            finishLocaleUpdate(localeCode, NoError);
+        });
+        response->onError([this, localeCode](const QDBusError &error) {
+            qWarning() << "Reboot request failed:" << error.name() << error.message();
+            finishLocaleUpdate(localeCode, RebootFailedError);
+        });
+    } else {
+        finishLocaleUpdate(localeCode, NoError);
+        // Re-sort once the application has applied the new default locale.
+        QTimer::singleShot(0, LanguageCatalogue::instance(), &LanguageCatalogue::checkLocale);
     }
 }
 
-QList<Language> LanguageModel::supportedLanguages()
+void LanguageModel::finishLocaleUpdate(const QString &localeCode, LocaleUpdateError error)
 {
-    // get supported languages
-    QDir languageDirectory(LanguageSupportDirectory);
-    QFileInfoList fileInfoList = languageDirectory.entryInfoList(QStringList("*.conf"), QDir::Files);
-    QList<Language> languages;
-
-    foreach (const QFileInfo &fileInfo, fileInfoList) {
-        QSettings settings(fileInfo.filePath(), QSettings::IniFormat);
-        settings.setIniCodec("UTF-8");
-        QString name = settings.value("Name").toString();
-        QString localeCode = settings.value("LocaleCode").toString();
-        QString region = settings.value("Region").toString();
-        //% "Region: %1"
-        QString regionLabel = settings.value("RegionLabel", qtTrId("systemsettings-la-region")).toString();
-        if (name.isEmpty() || localeCode.isEmpty()) {
-            continue;
-        }
-        Language newLanguage(name, localeCode, region, regionLabel);
-        languages.append(newLanguage);
-    }
+    m_busy = false;
+    emit busyChanged();
+    emit setSystemLocaleFinished(localeCode, error);
+}
 
-    std::sort(languages.begin(), languages.end(), nameLessThan);
-    return languages;
+QList<Language> LanguageModel::supportedLanguages()
+{
+    return LanguageCatalogue::instance()->languages();
 }
 
 int LanguageModel::getLocaleIndex(const QString &locale) const
 {
-    int i = 0;
-    foreach (Language language, m_languages) {
-        if (language.localeCode() == locale) {
-            return i;
-        }
-        i++;
-    }
-
-    return -1;
+    return LanguageCatalogue::instance()->indexOf(locale);
 }
@@ -57,7 +57,9 @@ class SYSTEMSETTINGS_EXPORT LanguageModel: public QAbstractListModel
 {
     Q_OBJECT
     Q_PROPERTY(int currentIndex READ currentIndex NOTIFY currentIndexChanged)
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
     Q_ENUMS(LocaleUpdateMode)
+    Q_ENUMS(LocaleUpdateError)
 
 public:
     enum LanguageRoles {
@@ -72,6 +74,14 @@ public:
         UpdateWithoutReboot
     };
 
+    enum LocaleUpdateError {
+        NoError,
+        BusyError,
+        HelperNotFoundError,
+        HelperFailedError,
+        RebootFailedError
+    };
+
     explicit LanguageModel(QObject *parent = 0);
     virtual ~LanguageModel();
 
@@ -79,16 +89,20 @@ public:
     virtual QVariant data(const QModelIndex &index, int role) const;
 
     int currentIndex() const;
+    bool busy() const;
 
     Q_INVOKABLE QString languageName(int index) const;
     Q_INVOKABLE QString locale(int index) const;
 
+    // Asynchronous, busy is set until setSystemLocaleFinished() is emitted.
     Q_INVOKABLE void setSystemLocale(const QString &localeCode, LocaleUpdateMode updateMode);
 
     static QList<Language> supportedLanguages();
 
 signals:
     void currentIndexChanged();
+    void busyChanged();
+    void setSystemLocaleFinished(const QString &localeCode, LocaleUpdateError error);
 
 protected:
     QHash<int, QByteArray> roleNames() const;
@@ -96,9 +110,13 @@ protected:
 private:
     void readCurrentLocale();
     int getLocaleIndex(const QString &locale) const;
+    void runLocaleHelper(const QString &localeCode, LocaleUpdateMode updateMode);
+    void localeUpdated(const QString &localeCode, LocaleUpdateMode updateMode);
+    void finishLocaleUpdate(const QString &localeCode, LocaleUpdateError error);
 
     QList<Language> m_languages;
     int m_currentIndex;
+    bool m_busy;
 };
 
 #endif
@@ -40,9 +40,14 @@
 #include <sys/types.h>
 
 QString localeConfigPath()
+{
+    return userLocaleConfigPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation));
+}
+
+QString userLocaleConfigPath(const QString &homePath)
 {
     // User-wide locale config
-    return QString("%1/.config/locale.conf").arg(QStandardPaths::writableLocation(QStandardPaths::HomeLocation));
+    return QString("%1/.config/locale.conf").arg(homePath);
 }
 
 QString systemLocaleConfigPath()
@@ -37,6 +37,7 @@
 #include <QString>
 
 QString localeConfigPath();
+QString userLocaleConfigPath(const QString &homePath);
 QString systemLocaleConfigPath();
 QString preferredLocaleConfigPath();
 
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "mounttable_p.h"
+#include "logging_p.h"
+
+#include <QHash>
+#include <QSocketNotifier>
+
+namespace {
+
+// Mount paths and sources escape space, tab, newline and backslash as \ooo.
+QString unescape(const QByteArray &field)
+{
+    if (!field.contains('\\')) {
+        return QString::fromUtf8(field);
+    }
+
+    QByteArray result;
+    result.reserve(field.size());
+    for (int i = 0; i < field.size(); ++i) {
+        if (field.at(i) == '\\' && i + 3 < field.size()) {
+            bool ok = false;
+            const int c = field.mid(i + 1, 3).toInt(&ok, 8);
+            if (ok) {
+                result.append(char(c));
+                i += 3;
+                continue;
+            }
+        }
+        result.append(field.at(i));
+    }
+    return QString::fromUtf8(result);
+}
+
+}
+
+MountTable::MountTable(QObject *parent)
+    : QObject(parent)
+    , m_mountInfo(QStringLiteral("/proc/self/mountinfo"))
+    , m_notifier(nullptr)
+{
+    if (m_mountInfo.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        m_notifier = new QSocketNotifier(m_mountInfo.handle(), QSocketNotifier::Exception, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &MountTable::reload);
+        m_entries = parse(read());
+    } else {
+        qCWarning(lcMemoryCardLog) << "Cannot watch mount table:" << m_mountInfo.errorString();
+    }
+}
+
+MountTable::~MountTable()
+{
+}
+
+QVector<MountEntry> MountTable::entries()
+{
+    // Without change notifications the snapshot cannot be trusted, read it every time.
+    if (!m_notifier) {
+        return parse(read());
+    }
+    return m_entries;
+}
+
+QVector<MountEntry> MountTable::parse(const QByteArray &mountInfo)
+{
+    // 36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+    // (1)(2)(3)   (4)   (5)         (6)       (7)     (8)(9)  (10)      (11)
+    QVector<MountEntry> entries;
+    for (const QByteArray &line : mountInfo.split('\n')) {
+        const QList<QByteArray> fields = line.split(' ');
+        const int separator = fields.indexOf("-", 6);
+        if (fields.count() < 6 || separator == -1 || separator + 2 >= fields.count()) {
+            continue;
+        }
+
+        MountEntry entry;
+        entry.mountId = fields.at(0).toInt();
+        entry.mountPath = unescape(fields.at(4));
+        entry.mountOptions = QString::fromUtf8(fields.at(5));
+        entry.filesystemType = unescape(fields.at(separator + 1));
+        entry.devicePath = unescape(fields.at(separator + 2));
+        entries.append(entry);
+    }
+    return entries;
+}
+
+void MountTable::reload()
+{
+    const QVector<MountEntry> entries = parse(read());
+
+    QHash<int, int> previous;
+    for (int i = 0; i < m_entries.count(); ++i) {
+        previous.insert(m_entries.at(i).mountId, i);
+    }
+
+    QVector<MountEntry> added;
+    QVector<MountEntry> changed;
+    for (const MountEntry &entry : entries) {
+        const int index = previous.value(entry.mountId, -1);
+        if (index == -1) {
+            added.append(entry);
+        } else {
+            const MountEntry &old = m_entries.at(index);
+            if (old.mountOptions != entry.mountOptions || old.devicePath != entry.devicePath
+                    || old.mountPath != entry.mountPath) {
+                changed.append(entry);
+            }
+            previous.remove(entry.mountId);
+        }
+    }
+
+    QVector<MountEntry> removed;
+    for (int index : previous) {
+        removed.append(m_entries.at(index));
+    }
+
+    m_entries = entries;
+
+    if (!added.isEmpty() || !removed.isEmpty() || !changed.isEmpty()) {
+        qCDebug(lcMemoryCardLog) << "Mount table changed, added:" << added.count()
+                                 << "removed:" << removed.count() << "changed:" << changed.count();
+        emit this->changed(added, removed, changed);
+    }
+}
+
+QByteArray MountTable::read()
+{
+    if (m_mountInfo.isOpen()) {
+        // Reading from the start acknowledges the change notification.
+        m_mountInfo.seek(0);
+        return m_mountInfo.readAll();
+    }
+
+    QFile mountInfo(m_mountInfo.fileName());
+    return mountInfo.open(QIODevice::ReadOnly) ? mountInfo.readAll() : QByteArray();
+}
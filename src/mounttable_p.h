@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef MOUNTTABLE_P_H
+#define MOUNTTABLE_P_H
+
+#include <QObject>
+#include <QFile>
+#include <QVector>
+
+class QSocketNotifier;
+
+struct MountEntry
+{
+    int mountId = -1;
+    QString devicePath;
+    QString mountPath;
+    QString filesystemType;
+    QString mountOptions;
+};
+
+// Keeps a parsed snapshot of /proc/self/mountinfo. The kernel signals
+// changes to the mount table as POLLPRI on the file, on which the
+// snapshot is re-read and the differences are reported.
+class MountTable : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MountTable(QObject *parent = nullptr);
+    ~MountTable();
+
+    QVector<MountEntry> entries();
+
+    static QVector<MountEntry> parse(const QByteArray &mountInfo);
+
+signals:
+    void changed(const QVector<MountEntry> &added, const QVector<MountEntry> &removed,
+                 const QVector<MountEntry> &changed);
+
+private slots:
+    void reload();
+
+private:
+    QByteArray read();
+
+    QFile m_mountInfo;
+    QSocketNotifier *m_notifier;
+    QVector<MountEntry> m_entries;
+};
+
+#endif
@@ -66,6 +66,11 @@ bool Partition::operator !=(const Partition &partition) const
     return d != partition.d;
 }
 
+uint qHash(const Partition &partition, uint seed)
+{
+    return qHash(partition.d.data(), seed);
+}
+
 bool Partition::isReadOnly() const
 {
     return !d || d->readOnly;
@@ -157,11 +162,31 @@ qint64 Partition::bytesFree() const
     return d ? d->bytesFree : 0;
 }
 
+qreal Partition::operationProgress() const
+{
+    return d ? d->operationProgress : -1;
+}
+
+qint64 Partition::operationRate() const
+{
+    return d ? d->operationRate : 0;
+}
+
+QDateTime Partition::operationExpectedEndTime() const
+{
+    return d ? d->operationExpectedEndTime : QDateTime();
+}
+
 void Partition::refresh()
 {
     if (const auto manager = d ? d->manager : nullptr) {
         manager->refresh(d.data());
+    }
+}
 
-        emit manager->partitionChanged(*this);
+void Partition::benchmark()
+{
+    if (const auto manager = d ? d->manager : nullptr) {
+        manager->benchmark(*this);
     }
 }
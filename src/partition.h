@@ -32,6 +32,7 @@
 #ifndef PARTITION_H
 #define PARTITION_H
 
+#include <QDateTime>
 #include <QSharedData>
 #include <QObject>
 
@@ -129,10 +130,21 @@ public:
     qint64 bytesTotal() const;
     qint64 bytesFree() const;
 
+    // Of a running format, mount or similar operation. Progress is from 0
+    // to 1, or -1 if unknown. Rate is in bytes per second.
+    qreal operationProgress() const;
+    qint64 operationRate() const;
+    QDateTime operationExpectedEndTime() const;
+
     void refresh();
 
+    // Runs a storage speed benchmark on a writable, mounted external
+    // partition. Results are reported through PartitionModel.
+    void benchmark();
+
 private:
     friend class PartitionManagerPrivate;
+    friend SYSTEMSETTINGS_EXPORT uint qHash(const Partition &partition, uint seed);
 
     explicit Partition(const QExplicitlySharedDataPointer<PartitionPrivate> &d);
 
@@ -141,4 +153,6 @@ private:
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Partition::StorageTypes)
 
+SYSTEMSETTINGS_EXPORT uint qHash(const Partition &partition, uint seed = 0);
+
 #endif
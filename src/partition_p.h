@@ -34,6 +34,7 @@
 
 #include "partition.h"
 
+#include <QDateTime>
 #include <QVariantMap>
 
 class PartitionManagerPrivate;
@@ -46,6 +47,8 @@ public:
         , bytesAvailable(0)
         , bytesTotal(0)
         , bytesFree(0)
+        , operationProgress(-1)
+        , operationRate(0)
         , storageType(Partition::Invalid)
         , status(Partition::Unmounted)
         , readOnly(true)
@@ -76,6 +79,10 @@ public:
     qint64 bytesAvailable;
     qint64 bytesTotal;
     qint64 bytesFree;
+    // Of the running UDisks2 job, e.g. format
+    qreal operationProgress;
+    qint64 operationRate;
+    QDateTime operationExpectedEndTime;
     Partition::StorageType storageType;
     Partition::Status status;
     QVariantMap drive;
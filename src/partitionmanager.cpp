@@ -31,17 +31,16 @@
  */
 
 #include "partitionmanager_p.h"
+#include "filesystemcapabilities_p.h"
+#include "storagebenchmark_p.h"
 #include "udisks2monitor_p.h"
 #include "udisks2blockdevices_p.h"
 #include "logging_p.h"
 
-#include <QFile>
 #include <QRegularExpression>
 
 #include <algorithm>
 #include <blkid/blkid.h>
-#include <linux/limits.h>
-#include <mntent.h>
 #include <sys/statvfs.h>
 #include <sys/quota.h>
 #include <unistd.h>
@@ -52,10 +51,13 @@ static const auto userName = QString(qgetenv("USER"));
 PartitionManagerPrivate *PartitionManagerPrivate::sharedInstance = nullptr;
 
 PartitionManagerPrivate::PartitionManagerPrivate()
+    : m_mountTable(new MountTable(this))
+    , m_benchmark(nullptr)
 {
     Q_ASSERT(!sharedInstance);
 
     sharedInstance = this;
+    connect(m_mountTable, &MountTable::changed, this, &PartitionManagerPrivate::mountsChanged);
     m_udisksMonitor.reset(new UDisks2::Monitor(this));
     connect(m_udisksMonitor.data(), &UDisks2::Monitor::status, this, &PartitionManagerPrivate::status);
     connect(m_udisksMonitor.data(), &UDisks2::Monitor::errorMessage, this, &PartitionManagerPrivate::errorMessage);
@@ -118,6 +120,10 @@ PartitionManagerPrivate::PartitionManagerPrivate()
     if (root->status == Partition::Mounted) {
         m_root = Partition(QExplicitlySharedDataPointer<PartitionPrivate>(root));
     }
+
+    for (const auto partition : m_partitions) {
+        m_partitionsByDevicePath.insert(partition->devicePath, partition);
+    }
 }
 
 PartitionManagerPrivate::~PartitionManagerPrivate()
@@ -158,6 +164,11 @@ QVector<Partition> PartitionManagerPrivate::partitions(const Partition::StorageT
     return partitions;
 }
 
+PartitionManagerPrivate::Partitions PartitionManagerPrivate::findPartitions(const QString &devicePath) const
+{
+    return m_partitionsByDevicePath.values(devicePath).toVector();
+}
+
 void PartitionManagerPrivate::add(QExplicitlySharedDataPointer<PartitionPrivate> partition)
 {
     int insertIndex = 0;
@@ -170,6 +181,7 @@ void PartitionManagerPrivate::add(QExplicitlySharedDataPointer<PartitionPrivate>
     }
 
     m_partitions.insert(insertIndex, partition);
+    m_partitionsByDevicePath.insert(partition->devicePath, partition);
     Partitions addedPartitions = { partition };
     refresh(addedPartitions, addedPartitions);
     emit partitionAdded(Partition(partition));
@@ -178,10 +190,10 @@ void PartitionManagerPrivate::add(QExplicitlySharedDataPointer<PartitionPrivate>
 void PartitionManagerPrivate::remove(const Partitions &partitions)
 {
     for (const auto removedPartition : partitions) {
-        for (int i = m_partitions.count() - 1; i >= 0 && m_partitions.at(i)->storageType == Partition::External; --i) {
-            const auto partition = m_partitions.at(i);
-            if (removedPartition->devicePath == partition->devicePath) {
-                m_partitions.removeAt(i);
+        for (const auto partition : findPartitions(removedPartition->devicePath)) {
+            if (partition->storageType == Partition::External) {
+                m_partitionsByDevicePath.remove(partition->devicePath, partition);
+                m_partitions.removeOne(partition);
             }
         }
 
@@ -189,6 +201,19 @@ void PartitionManagerPrivate::remove(const Partitions &partitions)
     }
 }
 
+void PartitionManagerPrivate::setDevicePath(const QExplicitlySharedDataPointer<PartitionPrivate> &partition, const QString &devicePath)
+{
+    if (partition->devicePath == devicePath) {
+        return;
+    }
+
+    // Partitions that are not added yet are indexed by add().
+    if (m_partitionsByDevicePath.remove(partition->devicePath, partition) > 0) {
+        m_partitionsByDevicePath.insert(devicePath, partition);
+    }
+    partition->devicePath = devicePath;
+}
+
 void PartitionManagerPrivate::refresh()
 {
     Partitions changedPartitions;
@@ -201,7 +226,7 @@ void PartitionManagerPrivate::refresh()
 
     refresh(m_partitions, changedPartitions);
     for (const auto partition : changedPartitions) {
-        emit partitionChanged(Partition(partition));
+        partitionChangedLater(partition);
     }
 }
 
@@ -209,7 +234,38 @@ void PartitionManagerPrivate::refresh(PartitionPrivate *partition)
 {
     refresh(Partitions() << QExplicitlySharedDataPointer<PartitionPrivate>(partition), Partitions() << QExplicitlySharedDataPointer<PartitionPrivate>(partition));
 
-    emit partitionChanged(Partition(QExplicitlySharedDataPointer<PartitionPrivate>(partition)));
+    partitionChangedLater(QExplicitlySharedDataPointer<PartitionPrivate>(partition));
+}
+
+void PartitionManagerPrivate::partitionChangedLater(const QExplicitlySharedDataPointer<PartitionPrivate> &partition)
+{
+    // A single UDisks2 signal burst refreshes the same partition several times,
+    // notify about it only once per event loop iteration.
+    if (m_changedPartitions.contains(partition)) {
+        return;
+    }
+
+    if (m_changedPartitions.isEmpty()) {
+        QMetaObject::invokeMethod(this, "flushChangedPartitions", Qt::QueuedConnection);
+    }
+    m_changedPartitions.append(partition);
+}
+
+void PartitionManagerPrivate::flushChangedPartitions()
+{
+    const Partitions changedPartitions = m_changedPartitions;
+    m_changedPartitions.clear();
+
+    QVector<Partition> partitions;
+    partitions.reserve(changedPartitions.count());
+    for (const auto partition : changedPartitions) {
+        partitions.append(Partition(partition));
+    }
+
+    for (const Partition &partition : partitions) {
+        emit partitionChanged(partition);
+    }
+    emit partitionsChanged(partitions);
 }
 
 void PartitionManagerPrivate::refresh(const Partitions &partitions, Partitions &changedPartitions)
@@ -231,17 +287,9 @@ void PartitionManagerPrivate::refresh(const Partitions &partitions, Partitions &
         }
     }
 
-    FILE *mtab = setmntent("/etc/mtab", "r");
-    mntent mountEntry;
-    char buffer[3 * PATH_MAX];
-
-    while (getmntent_r(mtab, &mountEntry, buffer, sizeof(buffer))) {
-        if (!mountEntry.mnt_fsname || !mountEntry.mnt_dir) {
-            continue;
-        }
-
-        const QString mountPath = QString::fromUtf8(mountEntry.mnt_dir);
-        const QString devicePath = QString::fromUtf8(mountEntry.mnt_fsname);
+    for (const MountEntry &mountEntry : m_mountTable->entries()) {
+        const QString &mountPath = mountEntry.mountPath;
+        const QString &devicePath = mountEntry.devicePath;
         const QString deviceName = devicePath.section(QChar('/'), 2);
 
         for (auto partition : partitions) {
@@ -256,13 +304,13 @@ void PartitionManagerPrivate::refresh(const Partitions &partitions, Partitions &
                         || (partition->storageType == Partition::External
                             && partition->devicePath == devicePath)) {
                 partition->mountPath = mountPath;
-                partition->devicePath = devicePath;
+                setDevicePath(partition, devicePath);
                 // There two values wrong for system partitions as devicePath will not start with mmcblk.
                 // Currently deviceName and deviceRoot are merely informative data fields.
                 partition->deviceName = deviceName;
                 partition->deviceRoot = deviceRoot.match(deviceName).hasMatch();
-                partition->filesystemType = QString::fromUtf8(mountEntry.mnt_type);
-                partition->isSupportedFileSystemType = supportedFileSystems().contains(partition->filesystemType);
+                partition->filesystemType = mountEntry.filesystemType;
+                partition->isSupportedFileSystemType = isSupportedFileSystem(partition->filesystemType);
                 partition->status = partition->activeState == QStringLiteral("deactivating")
                         ? Partition::Unmounting
                         : Partition::Mounted;
@@ -271,33 +319,84 @@ void PartitionManagerPrivate::refresh(const Partitions &partitions, Partitions &
         }
     }
 
-    endmntent(mtab);
-
     for (auto partition : partitions) {
         if (partition->status == Partition::Mounted) {
-            qint64 quotaAvailable = std::numeric_limits<qint64>::max();
-            struct if_dqblk quota;
-            if (::quotactl(QCMD(Q_GETQUOTA, USRQUOTA), partition->devicePath.toUtf8().constData(), ::getuid(), (caddr_t)&quota) == 0
-                    && quota.dqb_bsoftlimit != 0)
-                quotaAvailable = std::max((qint64)dbtob(quota.dqb_bsoftlimit) - (qint64)quota.dqb_curspace, 0LL);
-
-            struct statvfs64 stat;
-            if (::statvfs64(partition->mountPath.toUtf8().constData(), &stat) == 0) {
-                partition->bytesTotal = stat.f_blocks * stat.f_frsize;
-                qint64 bytesFree = stat.f_bfree * stat.f_frsize;
-                qint64 bytesAvailable = std::min((qint64)(stat.f_bavail * stat.f_frsize), quotaAvailable);
-                partition->readOnly = (stat.f_flag & ST_RDONLY) != 0;
-
-                if (partition->bytesFree != bytesFree || partition->bytesAvailable != bytesAvailable) {
+            SpaceInfo space;
+            if (readSpace(partition->devicePath, partition->mountPath, &space)) {
+                partition->bytesTotal = space.bytesTotal;
+                partition->readOnly = space.readOnly;
+
+                if (partition->bytesFree != space.bytesFree || partition->bytesAvailable != space.bytesAvailable) {
                     if (!changedPartitions.contains(partition)) {
                         changedPartitions.append(partition);
                     }
                 }
-                partition->bytesFree = bytesFree;
-                partition->bytesAvailable = bytesAvailable;
+                partition->bytesFree = space.bytesFree;
+                partition->bytesAvailable = space.bytesAvailable;
+            }
+        }
+    }
+}
+
+bool PartitionManagerPrivate::readSpace(const QString &devicePath, const QString &mountPath, SpaceInfo *space)
+{
+    qint64 quotaAvailable = std::numeric_limits<qint64>::max();
+    struct if_dqblk quota;
+    if (::quotactl(QCMD(Q_GETQUOTA, USRQUOTA), devicePath.toUtf8().constData(), ::getuid(), (caddr_t)&quota) == 0
+            && quota.dqb_bsoftlimit != 0)
+        quotaAvailable = std::max((qint64)dbtob(quota.dqb_bsoftlimit) - (qint64)quota.dqb_curspace, 0LL);
+
+    struct statvfs64 stat;
+    if (::statvfs64(mountPath.toUtf8().constData(), &stat) != 0) {
+        return false;
+    }
+
+    space->bytesTotal = stat.f_blocks * stat.f_frsize;
+    space->bytesFree = stat.f_bfree * stat.f_frsize;
+    space->bytesAvailable = std::min((qint64)(stat.f_bavail * stat.f_frsize), quotaAvailable);
+    space->readOnly = (stat.f_flag & ST_RDONLY) != 0;
+    return true;
+}
+
+void PartitionManagerPrivate::mountsChanged(const QVector<MountEntry> &added, const QVector<MountEntry> &removed,
+                                            const QVector<MountEntry> &changed)
+{
+    // Refresh only the partitions that the changed mounts refer to.
+    // Mounting may have loaded a new file system module.
+    for (const MountEntry &entry : added) {
+        if (!isSupportedFileSystem(entry.filesystemType)) {
+            FileSystemCapabilities::instance()->invalidateFileSystems();
+            break;
+        }
+    }
+
+    Partitions affectedPartitions;
+    for (const QVector<MountEntry> &entries : { added, removed, changed }) {
+        for (const MountEntry &entry : entries) {
+            for (const auto partition : findPartitions(entry.devicePath)) {
+                if (!affectedPartitions.contains(partition)) {
+                    affectedPartitions.append(partition);
+                }
+            }
+
+            for (const auto partition : m_partitions) {
+                if ((partition->storageType & Partition::Internal)
+                        && partition->mountPath == entry.mountPath
+                        && !affectedPartitions.contains(partition)) {
+                    affectedPartitions.append(partition);
+                }
             }
         }
     }
+
+    if (affectedPartitions.isEmpty()) {
+        return;
+    }
+
+    refresh(affectedPartitions, affectedPartitions);
+    for (const auto partition : affectedPartitions) {
+        partitionChangedLater(partition);
+    }
 }
 
 bool PartitionManagerPrivate::isActionAllowed(const QString &devicePath, const QString &action)
@@ -310,10 +409,26 @@ bool PartitionManagerPrivate::isActionAllowed(const QString &devicePath, const Q
     return true;
 }
 
+// A running benchmark holds a file open on the mount, which would make
+// operations on the device fail as busy.
+void PartitionManagerPrivate::stopBenchmark(const QString &devicePath)
+{
+    if (!m_benchmark || !m_benchmark->isRunning())
+        return;
+
+    if (devicePath == m_benchmark->devicePath()
+            || (!m_benchmarkBackingDevicePath.isEmpty() && devicePath == m_benchmarkBackingDevicePath)) {
+        qCInfo(lcMemoryCardLog) << "Cancelling storage benchmark of" << devicePath;
+        m_benchmark->cancelAndWait();
+    }
+}
+
 void PartitionManagerPrivate::lock(const QString &devicePath)
 {
-    if (isActionAllowed(devicePath, QStringLiteral("lock")))
+    if (isActionAllowed(devicePath, QStringLiteral("lock"))) {
+        stopBenchmark(devicePath);
         m_udisksMonitor->lock(devicePath);
+    }
 }
 
 void PartitionManagerPrivate::unlock(const Partition &partition, const QString &passphrase)
@@ -330,14 +445,55 @@ void PartitionManagerPrivate::mount(const Partition &partition)
 
 void PartitionManagerPrivate::unmount(const Partition &partition)
 {
-    if (isActionAllowed(partition.devicePath(), QStringLiteral("unmount")))
+    if (isActionAllowed(partition.devicePath(), QStringLiteral("unmount"))) {
+        stopBenchmark(partition.devicePath());
         m_udisksMonitor->unmount(partition.devicePath());
+    }
 }
 
 void PartitionManagerPrivate::format(const QString &devicePath, const QString &filesystemType, const QVariantMap &arguments)
 {
-    if (isActionAllowed(devicePath, QStringLiteral("format")))
+    if (isActionAllowed(devicePath, QStringLiteral("format"))) {
+        stopBenchmark(devicePath);
         m_udisksMonitor->format(devicePath, filesystemType, arguments);
+    }
+}
+
+void PartitionManagerPrivate::benchmark(const Partition &partition)
+{
+    if (partition.storageType() != Partition::External
+            || partition.status() != Partition::Mounted
+            || partition.isReadOnly()) {
+        qCWarning(lcMemoryCardLog) << "Benchmark allowed only for writable mounted external partitions,"
+                                   << partition.devicePath() << "is not allowed";
+        emit benchmarkError(partition.devicePath(), QStringLiteral("Not allowed"));
+        return;
+    }
+
+    if (!m_benchmark) {
+        m_benchmark = new StorageBenchmark(this);
+        connect(m_benchmark, &StorageBenchmark::runningChanged, this, &PartitionManagerPrivate::benchmarkRunningChanged);
+        connect(m_benchmark, &StorageBenchmark::progress, this, &PartitionManagerPrivate::benchmarkProgress);
+        connect(m_benchmark, &StorageBenchmark::finished, this, &PartitionManagerPrivate::benchmarkFinished);
+        connect(m_benchmark, &StorageBenchmark::cancelled, this, &PartitionManagerPrivate::benchmarkCancelled);
+        connect(m_benchmark, &StorageBenchmark::failed, this, &PartitionManagerPrivate::benchmarkError);
+    }
+
+    if (!m_benchmark->isRunning())
+        m_benchmarkBackingDevicePath = partition.cryptoBackingDevicePath();
+    m_benchmark->start(partition.devicePath(), partition.mountPath(), partition.bytesAvailable());
+}
+
+void PartitionManagerPrivate::cancelBenchmark()
+{
+    if (m_benchmark) {
+        m_benchmark->cancel();
+    }
+}
+
+bool PartitionManagerPrivate::benchmarkRunning() const
+{
+    return m_benchmark && m_benchmark->isRunning();
 }
 
 QString PartitionManagerPrivate::objectPath(const QString &devicePath) const
@@ -353,19 +509,12 @@ QString PartitionManagerPrivate::objectPath(const QString &devicePath) const
 
 QStringList PartitionManagerPrivate::supportedFileSystems() const
 {
-    // Query filesystems supported by this device
-    // Note this will only find filesystems supported either directly by the
-    // kernel, or by modules already loaded.
-    QStringList supportedFs;
-    QFile filesystems(QStringLiteral("/proc/filesystems"));
-    if (filesystems.open(QIODevice::ReadOnly)) {
-        QString line = filesystems.readLine();
-        while (line.length() > 0) {
-            supportedFs << line.trimmed().split('\t').last();
-            line = filesystems.readLine();
-        }
-    }
-    return supportedFs;
+    return FileSystemCapabilities::instance()->supportedFileSystems();
+}
+
+bool PartitionManagerPrivate::isSupportedFileSystem(const QString &filesystemType) const
+{
+    return FileSystemCapabilities::instance()->isSupportedFileSystem(filesystemType);
 }
 
 bool PartitionManagerPrivate::externalStoragesPopulated() const
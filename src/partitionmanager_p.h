@@ -34,11 +34,15 @@
 
 #include "partitionmanager.h"
 #include "partition_p.h"
+#include "mounttable_p.h"
 
 #include <QMap>
+#include <QMultiHash>
 #include <QVector>
 #include <QScopedPointer>
 
+class StorageBenchmark;
+
 namespace UDisks2 {
 class Monitor;
 }
@@ -50,6 +54,13 @@ class PartitionManagerPrivate : public QObject, public QSharedData
 public:
     typedef QVector<QExplicitlySharedDataPointer<PartitionPrivate>> Partitions;
 
+    struct SpaceInfo {
+        qint64 bytesTotal = 0;
+        qint64 bytesFree = 0;
+        qint64 bytesAvailable = 0;
+        bool readOnly = true;
+    };
+
     PartitionManagerPrivate();
     ~PartitionManagerPrivate();
 
@@ -57,14 +68,19 @@ public:
 
     Partition root() const;
     QVector<Partition> partitions(Partition::StorageTypes types) const;
+    Partitions findPartitions(const QString &devicePath) const;
 
     void add(QExplicitlySharedDataPointer<PartitionPrivate> partition);
     void remove(const Partitions &partitions);
+    void setDevicePath(const QExplicitlySharedDataPointer<PartitionPrivate> &partition, const QString &devicePath);
 
     void refresh();
     void refresh(PartitionPrivate *partition);
     void refresh(const Partitions &partitions, Partitions &changedPartitions);
 
+    // Thread safe, used also by the free space monitor worker.
+    static bool readSpace(const QString &devicePath, const QString &mountPath, SpaceInfo *space);
+
     void lock(const QString &devicePath);
     void unlock(const Partition &partition, const QString &passphrase);
     void mount(const Partition &partition);
@@ -73,11 +89,17 @@ public:
 
     QString objectPath(const QString &devicePath) const;
 
+    void benchmark(const Partition &partition);
+    void cancelBenchmark();
+    bool benchmarkRunning() const;
+
     QStringList supportedFileSystems() const;
+    bool isSupportedFileSystem(const QString &filesystemType) const;
     bool externalStoragesPopulated() const;
 
 signals:
     void partitionChanged(const Partition &partition);
+    void partitionsChanged(const QVector<Partition> &partitions);
     void partitionAdded(const Partition &partition);
     void partitionRemoved(const Partition &partition);
     void externalStoragesPopulatedChanged();
@@ -90,14 +112,32 @@ signals:
     void unmountError(Partition::Error error);
     void formatError(Partition::Error error);
 
+    void benchmarkRunningChanged();
+    void benchmarkProgress(const QString &devicePath, qreal progress);
+    void benchmarkFinished(const QString &devicePath, const QVariantMap &result);
+    void benchmarkCancelled(const QString &devicePath);
+    void benchmarkError(const QString &devicePath, const QString &message);
+
+private slots:
+    void flushChangedPartitions();
+    void mountsChanged(const QVector<MountEntry> &added, const QVector<MountEntry> &removed,
+                       const QVector<MountEntry> &changed);
+
 private:
+    void partitionChangedLater(const QExplicitlySharedDataPointer<PartitionPrivate> &partition);
     bool isActionAllowed(const QString &devicePath, const QString &action);
+    void stopBenchmark(const QString &devicePath);
     // TODO: This is leaking (Disks2::Monitor is never free'ed).
     static PartitionManagerPrivate *sharedInstance;
 
     Partitions m_partitions;
+    Partitions m_changedPartitions;
+    QMultiHash<QString, QExplicitlySharedDataPointer<PartitionPrivate>> m_partitionsByDevicePath;
     Partition m_root;
 
+    MountTable *m_mountTable;
+    StorageBenchmark *m_benchmark;
+    QString m_benchmarkBackingDevicePath;
     QScopedPointer<UDisks2::Monitor> m_udisksMonitor;
 
     // Allow direct access to the Partitions.
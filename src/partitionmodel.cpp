@@ -31,28 +31,43 @@
 
 #include "partitionmodel.h"
 #include "partitionmanager_p.h"
+#include "filesystemcapabilities_p.h"
+#include "iostatistics_p.h"
+#include "dbuscallstatistics_p.h"
 
 #include "logging_p.h"
 
-#include <QDir>
-#include <QFileInfo>
+#include <QSet>
 #include <QtQml/qqmlinfo.h>
 
+#include <algorithm>
+
 PartitionModel::PartitionModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_manager(PartitionManagerPrivate::instance())
     , m_storageTypes(Any | ExcludeParents)
+    , m_ioStatistics(nullptr)
 {
     m_partitions = m_manager->partitions(Partition::Any | Partition::ExcludeParents);
 
-    connect(m_manager.data(), &PartitionManagerPrivate::partitionChanged, this, &PartitionModel::partitionChanged);
+    connect(m_manager.data(), &PartitionManagerPrivate::partitionsChanged, this, &PartitionModel::partitionsChanged);
     connect(m_manager.data(), &PartitionManagerPrivate::partitionAdded, this, &PartitionModel::partitionAdded);
     connect(m_manager.data(), &PartitionManagerPrivate::partitionRemoved, this, &PartitionModel::partitionRemoved);
     connect(m_manager.data(), &PartitionManagerPrivate::externalStoragesPopulatedChanged,
             this, &PartitionModel::externalStoragesPopulatedChanged);
 
+    connect(FileSystemCapabilities::instance(), &FileSystemCapabilities::formatTypesChanged,
+            this, &PartitionModel::supportedFormatTypesChanged);
+
     connect(m_manager.data(), &PartitionManagerPrivate::errorMessage, this, &PartitionModel::errorMessage);
 
+    connect(m_manager.data(), &PartitionManagerPrivate::benchmarkRunningChanged,
+            this, &PartitionModel::benchmarkRunningChanged);
+    connect(m_manager.data(), &PartitionManagerPrivate::benchmarkProgress, this, &PartitionModel::benchmarkProgress);
+    connect(m_manager.data(), &PartitionManagerPrivate::benchmarkFinished, this, &PartitionModel::benchmarkFinished);
+    connect(m_manager.data(), &PartitionManagerPrivate::benchmarkCancelled, this, &PartitionModel::benchmarkCancelled);
+    connect(m_manager.data(), &PartitionManagerPrivate::benchmarkError, this, &PartitionModel::benchmarkError);
+
     connect(m_manager.data(), &PartitionManagerPrivate::lockError, this, [this](Partition::Error error) {
         emit lockError(static_cast<PartitionModel::Error>(error));
     });
@@ -93,20 +108,7 @@ void PartitionModel::setStorageTypes(StorageTypes types)
 
 QStringList PartitionModel::supportedFormatTypes() const
 {
-    QStringList types;
-    QDir dir("/sbin/");
-    QStringList entries = dir.entryList(QStringList() << QString("mkfs.*"));
-    for (const QString &entry : entries) {
-        QFileInfo info(QString("/sbin/%1").arg(entry));
-        if (info.exists() && info.isExecutable()) {
-            QStringList parts = entry.split('.');
-            if (!parts.isEmpty()) {
-                types << parts.takeLast();
-            }
-        }
-    }
-
-    return types;
+    return FileSystemCapabilities::instance()->formatTypes();
 }
 
 bool PartitionModel::externalStoragesPopulated() const
@@ -114,6 +116,56 @@ bool PartitionModel::externalStoragesPopulated() const
     return m_manager->externalStoragesPopulated();
 }
 
+bool PartitionModel::benchmarkRunning() const
+{
+    return m_manager->benchmarkRunning();
+}
+
+bool PartitionModel::ioStatisticsEnabled() const
+{
+    return m_ioStatistics != nullptr;
+}
+
+void PartitionModel::setIoStatisticsEnabled(bool enabled)
+{
+    if (enabled == ioStatisticsEnabled()) {
+        return;
+    }
+
+    if (enabled) {
+        m_ioStatistics = new IoStatisticsSampler(this);
+        connect(m_ioStatistics, &IoStatisticsSampler::updated, this, &PartitionModel::ioStatisticsUpdated);
+        updateIoStatisticsDevices();
+    } else {
+        delete m_ioStatistics;
+        m_ioStatistics = nullptr;
+        ioStatisticsUpdated();
+    }
+
+    emit ioStatisticsEnabledChanged();
+}
+
+void PartitionModel::updateIoStatisticsDevices()
+{
+    if (m_ioStatistics) {
+        QStringList devicePaths;
+        for (const Partition &partition : m_partitions) {
+            devicePaths.append(partition.devicePath());
+        }
+        m_ioStatistics->setDevices(devicePaths);
+    }
+}
+
+void PartitionModel::ioStatisticsUpdated()
+{
+    if (!m_partitions.isEmpty()) {
+        static const QVector<int> roles = {
+            ReadBytesPerSecondRole, WriteBytesPerSecondRole, OperationsPerSecondRole, AverageLatencyRole
+        };
+        emit dataChanged(createIndex(0, 0), createIndex(m_partitions.count() - 1, 0), roles);
+    }
+}
+
 void PartitionModel::refresh()
 {
     m_manager->refresh();
@@ -135,8 +187,9 @@ void PartitionModel::lock(const QString &devicePath)
 void PartitionModel::unlock(const QString &devicePath, const QString &passphrase)
 {
     qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath << m_partitions.count();
-    if (const Partition *partition = getPartition(devicePath)) {
-        m_manager->unlock(*partition, passphrase);
+    const Partition partition = getPartition(devicePath);
+    if (partition.storageType() != Partition::Invalid) {
+        m_manager->unlock(partition, passphrase);
     } else {
         qCWarning(lcMemoryCardLog) << "Unable to unlock unknown device:" << devicePath;
     }
@@ -145,8 +198,9 @@ void PartitionModel::unlock(const QString &devicePath, const QString &passphrase
 void PartitionModel::mount(const QString &devicePath)
 {
     qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath << m_partitions.count();
-    if (const Partition *partition = getPartition(devicePath)) {
-        m_manager->mount(*partition);
+    const Partition partition = getPartition(devicePath);
+    if (partition.storageType() != Partition::Invalid) {
+        m_manager->mount(partition);
     } else {
         qCWarning(lcMemoryCardLog) << "Unable to mount unknown device:" << devicePath;
     }
@@ -155,8 +209,9 @@ void PartitionModel::mount(const QString &devicePath)
 void PartitionModel::unmount(const QString &devicePath)
 {
     qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath << m_partitions.count();
-    if (const Partition *partition = getPartition(devicePath)) {
-        m_manager->unmount(*partition);
+    const Partition partition = getPartition(devicePath);
+    if (partition.storageType() != Partition::Invalid) {
+        m_manager->unmount(partition);
     } else {
         qCWarning(lcMemoryCardLog) << "Unable to unmount unknown device:" << devicePath;
     }
@@ -195,57 +250,235 @@ QString PartitionModel::objectPath(const QString &devicePath) const
     return m_manager->objectPath(devicePath);
 }
 
+void PartitionModel::benchmark(const QString &devicePath)
+{
+    qCInfo(lcMemoryCardLog) << Q_FUNC_INFO << devicePath;
+    Partition partition = getPartition(devicePath);
+    if (partition.storageType() != Partition::Invalid) {
+        partition.benchmark();
+    } else {
+        qCWarning(lcMemoryCardLog) << "Unable to benchmark unknown device:" << devicePath;
+    }
+}
+
+void PartitionModel::cancelBenchmark()
+{
+    m_manager->cancelBenchmark();
+}
+
+QVariantMap PartitionModel::dbusCallStatistics() const
+{
+    return DBusCallStatistics::instance()->statistics();
+}
+
+void PartitionModel::resetDBusCallStatistics()
+{
+    DBusCallStatistics::instance()->reset();
+}
+
+// Returns the indices of one longest strictly increasing subsequence of values.
+static QVector<int> longestIncreasingSubsequence(const QVector<int> &values)
+{
+    QVector<int> tails;                              // index of the smallest tail of each length
+    QVector<int> predecessors(values.count(), -1);
+
+    for (int i = 0; i < values.count(); ++i) {
+        const auto it = std::lower_bound(tails.begin(), tails.end(), values.at(i), [&values](int index, int value) {
+            return values.at(index) < value;
+        });
+        const int length = it - tails.begin();
+        if (length > 0) {
+            predecessors[i] = tails.at(length - 1);
+        }
+        if (it == tails.end()) {
+            tails.append(i);
+        } else {
+            *it = i;
+        }
+    }
+
+    QVector<int> subsequence(tails.count());
+    for (int i = tails.isEmpty() ? -1 : tails.last(), length = tails.count(); i != -1; i = predecessors.at(i)) {
+        subsequence[--length] = i;
+    }
+    return subsequence;
+}
+
+// Fenwick tree over a fixed set of ordered slots, each either holding a row
+// or not. The row of an occupied slot is the number of occupied slots before it.
+class RowIndex
+{
+public:
+    explicit RowIndex(int slots) : m_tree(slots + 1, 0) {}
+
+    void occupy(int slot) { add(slot, 1); }
+    void release(int slot) { add(slot, -1); }
+
+    int row(int slot) const
+    {
+        int row = 0;
+        for (int i = slot; i > 0; i -= i & -i) {
+            row += m_tree.at(i);
+        }
+        return row;
+    }
+
+private:
+    void add(int slot, int delta)
+    {
+        for (int i = slot + 1; i < m_tree.count(); i += i & -i) {
+            m_tree[i] += delta;
+        }
+    }
+
+    QVector<int> m_tree;
+};
+
 void PartitionModel::update()
 {
     const int count = m_partitions.count();
 
     const auto partitions = m_manager->partitions(Partition::StorageTypes(int(m_storageTypes)));
 
-    int index = 0;
+    QHash<Partition, int> targets;
+    targets.reserve(partitions.count());
+    for (int i = 0; i < partitions.count(); ++i) {
+        targets.insert(partitions.at(i), i);
+    }
+
+    // Remove stale rows, one range at a time starting from the end.
+    for (int last = m_partitions.count() - 1; last >= 0;) {
+        if (targets.contains(m_partitions.at(last))) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !targets.contains(m_partitions.at(first - 1))) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        m_partitions.remove(first, last - first + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
 
-    for (const auto partition : partitions) {
-        const int existingIndex = [this, index, partition]() {
-            for (int i = index; i < m_partitions.count(); ++i) {
-                if (m_partitions.at(i) == partition) {
-                    return i;
-                }
-            }
-            return -1;
-        }();
+    // Rows forming the longest run already in the right relative order stay
+    // where they are, everything else is moved or inserted around them.
+    QVector<bool> present(partitions.count(), false);
+    QVector<bool> stable(partitions.count(), false);
+    QVector<int> currentRows(partitions.count(), -1);
+    QVector<int> positions;
+    positions.reserve(m_partitions.count());
+    for (int row = 0; row < m_partitions.count(); ++row) {
+        const int target = targets.value(m_partitions.at(row));
+        present[target] = true;
+        currentRows[target] = row;
+        positions.append(target);
+    }
+    for (int index : longestIncreasingSubsequence(positions)) {
+        stable[positions.at(index)] = true;
+    }
 
-        if (existingIndex == -1) {
-            beginInsertRows(QModelIndex(), index, index);
-            m_partitions.insert(index, partition);
-            endInsertRows();
-        } else if (existingIndex > index) {
-            beginMoveRows(QModelIndex(), existingIndex, existingIndex, QModelIndex(), index);
-            const auto partition = m_partitions.takeAt(existingIndex);
-            m_partitions.insert(index, partition);
-            endMoveRows();
+    // Every partition that is not stable ends up right before the next stable
+    // one, or at the end. Order the rows as they are now and the places they
+    // are moved to in one slot sequence so rows can be looked up as they move:
+    // the places in front of a row come first, in target order, then the row.
+    QVector<int> placeRows(partitions.count(), -1);
+    for (int target = partitions.count() - 1, next = m_partitions.count(); target >= 0; --target) {
+        if (stable.at(target)) {
+            next = currentRows.at(target);
+        } else {
+            placeRows[target] = next;
         }
-        ++index;
+    }
+    QVector<QVector<int>> placesBefore(m_partitions.count() + 1);
+    for (int target = 0; target < partitions.count(); ++target) {
+        if (placeRows.at(target) != -1) {
+            placesBefore[placeRows.at(target)].append(target);
+        }
+    }
+    QVector<int> rowSlots(m_partitions.count());
+    QVector<int> placeSlots(partitions.count(), -1);
+    int slots = 0;
+    for (int row = 0; row <= m_partitions.count(); ++row) {
+        for (int target : placesBefore.at(row)) {
+            placeSlots[target] = slots++;
+        }
+        if (row < m_partitions.count()) {
+            rowSlots[row] = slots++;
+        }
+    }
+    RowIndex rows(slots);
+    for (int slot : rowSlots) {
+        rows.occupy(slot);
     }
 
-    if (index < m_partitions.count()) {
-        beginRemoveRows(QModelIndex(), index, m_partitions.count() - 1);
-        m_partitions.resize(index);
-        endRemoveRows();
+    // Walk backwards placing each range right before its already placed successor.
+    for (int last = partitions.count() - 1; last >= 0;) {
+        if (stable.at(last)) {
+            --last;
+            continue;
+        }
+
+        int anchor = m_partitions.count();
+        if (last + 1 < partitions.count()) {
+            anchor = rows.row(stable.at(last + 1) ? rowSlots.at(currentRows.at(last + 1)) : placeSlots.at(last + 1));
+        }
+        int first = last;
+
+        if (!present.at(last)) {
+            while (first > 0 && !present.at(first - 1)) {
+                --first;
+            }
+            beginInsertRows(QModelIndex(), anchor, anchor + last - first);
+            for (int i = first; i <= last; ++i) {
+                m_partitions.insert(anchor + i - first, partitions.at(i));
+                rows.occupy(placeSlots.at(i));
+            }
+            endInsertRows();
+        } else {
+            const int lastRow = rows.row(rowSlots.at(currentRows.at(last)));
+            int firstRow = lastRow;
+            while (first > 0 && firstRow > 0 && present.at(first - 1) && !stable.at(first - 1)
+                   && m_partitions.at(firstRow - 1) == partitions.at(first - 1)) {
+                --first;
+                --firstRow;
+            }
+            if (anchor != lastRow + 1) {
+                beginMoveRows(QModelIndex(), firstRow, lastRow, QModelIndex(), anchor);
+                if (anchor > lastRow) {
+                    std::rotate(m_partitions.begin() + firstRow, m_partitions.begin() + lastRow + 1, m_partitions.begin() + anchor);
+                } else {
+                    std::rotate(m_partitions.begin() + anchor, m_partitions.begin() + firstRow, m_partitions.begin() + lastRow + 1);
+                }
+                endMoveRows();
+            }
+            // A range already right before its successor keeps its rows either way.
+            for (int i = first; i <= last; ++i) {
+                rows.release(rowSlots.at(currentRows.at(i)));
+                rows.occupy(placeSlots.at(i));
+            }
+        }
+        last = first - 1;
     }
 
+    updateIoStatisticsDevices();
+
     if (count != m_partitions.count()) {
         emit countChanged();
     }
 }
 
-const Partition *PartitionModel::getPartition(const QString &devicePath) const
+// Only the rows of this model, a model excluding parents must not act on them.
+Partition PartitionModel::getPartition(const QString &devicePath) const
 {
     for (const Partition &partition : m_partitions) {
         if (devicePath == partition.devicePath()) {
-            return &partition;
+            return partition;
         }
     }
 
-    return nullptr;
+    return Partition();
 }
 
 QHash<int, QByteArray> PartitionModel::roleNames() const
@@ -270,6 +503,13 @@ QHash<int, QByteArray> PartitionModel::roleNames() const
         { IsEncryptedRoles, "isEncrypted"},
         { CryptoBackingDevicePath, "cryptoBackingDevicePath"},
         { DriveRole, "drive"},
+        { ReadBytesPerSecondRole, "readBytesPerSecond" },
+        { WriteBytesPerSecondRole, "writeBytesPerSecond" },
+        { OperationsPerSecondRole, "operationsPerSecond" },
+        { AverageLatencyRole, "averageLatency" },
+        { OperationProgressRole, "operationProgress" },
+        { OperationRateRole, "operationRate" },
+        { OperationExpectedEndTimeRole, "operationExpectedEndTime" },
     };
 
     return roleNames;
@@ -326,22 +566,52 @@ QVariant PartitionModel::data(const QModelIndex &index, int role) const
             return partition.cryptoBackingDevicePath();
         case DriveRole:
             return partition.drive();
+        case ReadBytesPerSecondRole:
+            return m_ioStatistics ? m_ioStatistics->statistics(partition.devicePath()).readBytesPerSecond : 0;
+        case WriteBytesPerSecondRole:
+            return m_ioStatistics ? m_ioStatistics->statistics(partition.devicePath()).writeBytesPerSecond : 0;
+        case OperationsPerSecondRole:
+            return m_ioStatistics ? m_ioStatistics->statistics(partition.devicePath()).operationsPerSecond : 0;
+        case AverageLatencyRole:
+            return m_ioStatistics ? m_ioStatistics->statistics(partition.devicePath()).averageLatency : 0;
+        case OperationProgressRole:
+            return partition.operationProgress();
+        case OperationRateRole:
+            return partition.operationRate();
+        case OperationExpectedEndTimeRole:
+            return partition.operationExpectedEndTime();
         default:
             return QVariant();
         }
     }
 }
 
-void PartitionModel::partitionChanged(const Partition &partition)
+void PartitionModel::partitionsChanged(const QVector<Partition> &partitions)
 {
-    for (int i = 0; i < m_partitions.count(); ++i) {
-        qCInfo(lcMemoryCardLog) << "partition changed:" << partition.status() << partition.mountPath();;
-        if (m_partitions.at(i) == partition) {
-            QModelIndex index = createIndex(i, 0);
-            emit dataChanged(index, index);
-            return;
+    QSet<Partition> changedPartitions;
+    changedPartitions.reserve(partitions.count());
+    for (const Partition &partition : partitions) {
+        changedPartitions.insert(partition);
+    }
+
+    // Emit one dataChanged per contiguous range of changed rows.
+    int first = -1;
+    for (int i = 0; i <= m_partitions.count(); ++i) {
+        const bool changed = i < m_partitions.count() && changedPartitions.contains(m_partitions.at(i));
+        if (changed) {
+            const Partition &partition = m_partitions.at(i);
+            qCInfo(lcMemoryCardLog) << "partition changed:" << partition.status() << partition.mountPath();
+            if (first == -1) {
+                first = i;
+            }
+        } else if (first != -1) {
+            emit dataChanged(createIndex(first, 0), createIndex(i - 1, 0));
+            first = -1;
         }
     }
+
+    // Unlocking or locking changes the device path of a partition.
+    updateIoStatisticsDevices();
 }
 
 void PartitionModel::partitionAdded(const Partition &partition)
@@ -359,6 +629,8 @@ void PartitionModel::partitionRemoved(const Partition &partition)
             m_partitions.removeAt(i);
             endRemoveRows();
 
+            updateIoStatisticsDevices();
+
             emit countChanged();
 
             return;
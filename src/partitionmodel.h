@@ -36,6 +36,8 @@
 
 #include <partitionmanager.h>
 
+class IoStatisticsSampler;
+
 class SYSTEMSETTINGS_EXPORT PartitionModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -44,8 +46,11 @@ class SYSTEMSETTINGS_EXPORT PartitionModel : public QAbstractListModel
     Q_FLAGS(StorageTypes)
     Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
     Q_PROPERTY(StorageTypes storageTypes READ storageTypes WRITE setStorageTypes NOTIFY storageTypesChanged)
-    Q_PROPERTY(QStringList supportedFormatTypes READ supportedFormatTypes CONSTANT)
+    Q_PROPERTY(QStringList supportedFormatTypes READ supportedFormatTypes NOTIFY supportedFormatTypesChanged)
     Q_PROPERTY(bool externalStoragesPopulated READ externalStoragesPopulated NOTIFY externalStoragesPopulatedChanged)
+    // Block device I/O is sampled only while enabled, the I/O roles are zero otherwise.
+    Q_PROPERTY(bool ioStatisticsEnabled READ ioStatisticsEnabled WRITE setIoStatisticsEnabled NOTIFY ioStatisticsEnabledChanged)
+    Q_PROPERTY(bool benchmarkRunning READ benchmarkRunning NOTIFY benchmarkRunningChanged)
 
 public:
     enum {
@@ -68,6 +73,13 @@ public:
         IsEncryptedRoles,
         CryptoBackingDevicePath,
         DriveRole,
+        ReadBytesPerSecondRole,
+        WriteBytesPerSecondRole,
+        OperationsPerSecondRole,
+        AverageLatencyRole,
+        OperationProgressRole,
+        OperationRateRole,
+        OperationExpectedEndTimeRole,
     };
 
     // For Status role
@@ -135,6 +147,11 @@ public:
     QStringList supportedFormatTypes() const;
     bool externalStoragesPopulated() const;
 
+    bool benchmarkRunning() const;
+
+    bool ioStatisticsEnabled() const;
+    void setIoStatisticsEnabled(bool enabled);
+
     Q_INVOKABLE void refresh();
     Q_INVOKABLE void refresh(int index);
 
@@ -146,6 +163,17 @@ public:
 
     Q_INVOKABLE QString objectPath(const QString &devicePath) const;
 
+    // Sequential and random 4K read/write benchmark of an external partition.
+    // benchmarkFinished() reports sequentialReadSpeed and sequentialWriteSpeed
+    // in MB/s, randomReadIops, randomWriteIops, speedClass and applicationClass.
+    Q_INVOKABLE void benchmark(const QString &devicePath);
+    Q_INVOKABLE void cancelBenchmark();
+
+    // Debugging aid: per "interface.method" calls, errors, averageLatency and
+    // maximumLatency in ms, and a histogram of power of two millisecond buckets.
+    Q_INVOKABLE QVariantMap dbusCallStatistics() const;
+    Q_INVOKABLE void resetDBusCallStatistics();
+
     QHash<int, QByteArray> roleNames() const;
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
@@ -154,7 +182,10 @@ public:
 signals:
     void countChanged();
     void storageTypesChanged();
+    void supportedFormatTypesChanged();
     void externalStoragesPopulatedChanged();
+    void ioStatisticsEnabledChanged();
+    void benchmarkRunningChanged();
 
     void errorMessage(const QString &objectPath, const QString &errorName);
     void lockError(Error error);
@@ -163,18 +194,27 @@ signals:
     void unmountError(Error error);
     void formatError(Error error);
 
+    void benchmarkProgress(const QString &devicePath, qreal progress);
+    void benchmarkFinished(const QString &devicePath, const QVariantMap &result);
+    void benchmarkCancelled(const QString &devicePath);
+    void benchmarkError(const QString &devicePath, const QString &message);
+
 private:
     void update();
 
-    const Partition *getPartition(const QString &devicePath) const;
+    Partition getPartition(const QString &devicePath) const;
 
-    void partitionChanged(const Partition &partition);
+    void partitionsChanged(const QVector<Partition> &partitions);
     void partitionAdded(const Partition &partition);
     void partitionRemoved(const Partition &partition);
 
+    void updateIoStatisticsDevices();
+    void ioStatisticsUpdated();
+
     QExplicitlySharedDataPointer<PartitionManagerPrivate> m_manager;
     QVector<Partition> m_partitions;
     StorageTypes m_storageTypes;
+    IoStatisticsSampler *m_ioStatistics;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(PartitionModel::StorageTypes)
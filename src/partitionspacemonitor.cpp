@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "partitionspacemonitor.h"
+#include "partitionspacemonitor_p.h"
+#include "partitionmanager.h"
+#include "partitionmanager_p.h"
+#include "logging_p.h"
+
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace {
+
+// All monitors sample on one thread, which is stopped with the last of them.
+QThread *workerThread = nullptr;
+int workerThreadUsers = 0;
+
+QThread *acquireWorkerThread()
+{
+    if (!workerThread) {
+        workerThread = new QThread;
+        workerThread->start();
+    }
+    ++workerThreadUsers;
+    return workerThread;
+}
+
+void releaseWorkerThread()
+{
+    if (--workerThreadUsers == 0) {
+        // Finishing the thread runs the pending deleteLater of the workers.
+        workerThread->quit();
+        workerThread->wait();
+        delete workerThread;
+        workerThread = nullptr;
+    }
+}
+
+}
+
+PartitionSpaceWorker::PartitionSpaceWorker(QObject *parent)
+    : QObject(parent)
+    , m_timer(nullptr)
+    , m_generation(0)
+    , m_lowSpaceThreshold(0)
+    , m_recoveryThreshold(0)
+    , m_lastAvailable(-1)
+    , m_spaceLow(false)
+{
+}
+
+PartitionSpaceWorker::~PartitionSpaceWorker()
+{
+}
+
+// Aim to sample about four times before the next threshold can be crossed
+// at the current rate of change.
+int PartitionSpaceWorker::nextInterval(qint64 distance, qint64 consumed, qint64 elapsed)
+{
+    if (distance <= 0) {
+        return MinimumInterval;
+    } else if (consumed <= 0 || elapsed <= 0) {
+        return MaximumInterval;
+    }
+
+    const qreal remaining = qreal(distance) * elapsed / consumed / 4;
+    return qBound<qreal>(MinimumInterval, remaining, MaximumInterval);
+}
+
+void PartitionSpaceWorker::watch(int generation, const QString &devicePath, const QString &mountPath,
+                                 qint64 lowSpaceThreshold, qint64 recoveryThreshold, bool spaceLow)
+{
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        m_timer->setSingleShot(true);
+        connect(m_timer, &QTimer::timeout, this, &PartitionSpaceWorker::sample);
+    }
+
+    m_generation = generation;
+    m_devicePath = devicePath;
+    m_mountPath = mountPath;
+    m_lowSpaceThreshold = lowSpaceThreshold;
+    m_recoveryThreshold = std::max(recoveryThreshold, lowSpaceThreshold);
+    m_lastAvailable = -1;
+    m_spaceLow = spaceLow;
+
+    sample();
+}
+
+void PartitionSpaceWorker::stop()
+{
+    if (m_timer) {
+        m_timer->stop();
+    }
+    m_mountPath.clear();
+}
+
+void PartitionSpaceWorker::sample()
+{
+    if (m_mountPath.isEmpty()) {
+        return;
+    }
+
+    PartitionManagerPrivate::SpaceInfo space;
+    if (!PartitionManagerPrivate::readSpace(m_devicePath, m_mountPath, &space)) {
+        qCWarning(lcMemoryCardLog) << "Unable to read free space of" << m_mountPath;
+        m_lastAvailable = -1;
+        m_timer->start(MaximumInterval);
+        return;
+    }
+
+    if (!m_spaceLow && space.bytesAvailable < m_lowSpaceThreshold) {
+        m_spaceLow = true;
+    } else if (m_spaceLow && space.bytesAvailable >= m_recoveryThreshold) {
+        m_spaceLow = false;
+    }
+
+    emit sampled(m_generation, space.bytesTotal, space.bytesFree, space.bytesAvailable, m_spaceLow);
+
+    const qint64 elapsed = m_elapsed.restart();
+    int interval = MaximumInterval;
+    if (m_lastAvailable >= 0) {
+        interval = m_spaceLow
+                ? nextInterval(m_recoveryThreshold - space.bytesAvailable, space.bytesAvailable - m_lastAvailable, elapsed)
+                : nextInterval(space.bytesAvailable - m_lowSpaceThreshold, m_lastAvailable - space.bytesAvailable, elapsed);
+    } else {
+        interval = MinimumInterval;
+    }
+    m_lastAvailable = space.bytesAvailable;
+
+    m_timer->start(interval);
+}
+
+class PartitionSpaceMonitorPrivate
+{
+    Q_DISABLE_COPY(PartitionSpaceMonitorPrivate)
+    Q_DECLARE_PUBLIC(PartitionSpaceMonitor)
+
+    PartitionSpaceMonitor * const q_ptr;
+
+public:
+    PartitionSpaceMonitorPrivate(PartitionSpaceMonitor *monitor);
+    ~PartitionSpaceMonitorPrivate();
+
+    void update(bool restart = false);
+    void sampled(int generation, qint64 bytesTotal, qint64 bytesFree, qint64 bytesAvailable, bool spaceLow);
+
+    PartitionManager m_manager;
+    PartitionSpaceWorker *m_worker;
+    QString m_mountPath;
+    QString m_devicePath;
+    qint64 m_lowSpaceThreshold;
+    qint64 m_recoveryThreshold;
+    qint64 m_bytesTotal;
+    qint64 m_bytesFree;
+    qint64 m_bytesAvailable;
+    int m_generation;
+    bool m_active;
+    bool m_watching;
+    bool m_spaceLow;
+};
+
+PartitionSpaceMonitorPrivate::PartitionSpaceMonitorPrivate(PartitionSpaceMonitor *monitor)
+    : q_ptr(monitor)
+    , m_worker(new PartitionSpaceWorker())
+    , m_lowSpaceThreshold(0)
+    , m_recoveryThreshold(0)
+    , m_bytesTotal(0)
+    , m_bytesFree(0)
+    , m_bytesAvailable(0)
+    , m_generation(0)
+    , m_active(true)
+    , m_watching(false)
+    , m_spaceLow(false)
+{
+    m_worker->moveToThread(acquireWorkerThread());
+
+    QObject::connect(m_worker, &PartitionSpaceWorker::sampled, monitor,
+                     [this](int generation, qint64 bytesTotal, qint64 bytesFree, qint64 bytesAvailable, bool spaceLow) {
+        sampled(generation, bytesTotal, bytesFree, bytesAvailable, spaceLow);
+    });
+
+    // Mounting and unmounting changes which device, if any, backs the mount path.
+    auto partitionsChanged = [this]() {
+        update();
+    };
+    QObject::connect(&m_manager, &PartitionManager::partitionChanged, monitor, partitionsChanged);
+    QObject::connect(&m_manager, &PartitionManager::partitionAdded, monitor, partitionsChanged);
+    QObject::connect(&m_manager, &PartitionManager::partitionRemoved, monitor, partitionsChanged);
+}
+
+PartitionSpaceMonitorPrivate::~PartitionSpaceMonitorPrivate()
+{
+    // Calls still queued for the worker are dropped with it.
+    m_worker->deleteLater();
+    releaseWorkerThread();
+}
+
+void PartitionSpaceMonitorPrivate::update(bool restart)
+{
+    const bool watching = m_active && !m_mountPath.isEmpty();
+
+    // Mount paths unknown to the partition manager, e.g. a directory within
+    // a partition, are still sampled but without the quota lookup.
+    QString devicePath;
+    if (watching) {
+        for (const Partition &partition : m_manager.partitions(Partition::Any)) {
+            if (partition.status() == Partition::Mounted && partition.mountPath() == m_mountPath) {
+                devicePath = partition.devicePath();
+                break;
+            }
+        }
+    }
+
+    if (!restart && watching == m_watching && devicePath == m_devicePath) {
+        return;
+    }
+
+    m_watching = watching;
+    m_devicePath = devicePath;
+
+    const int generation = ++m_generation;
+    PartitionSpaceWorker *worker = m_worker;
+    if (watching) {
+        const QString mountPath = m_mountPath;
+        const qint64 lowSpaceThreshold = m_lowSpaceThreshold;
+        const qint64 recoveryThreshold = m_recoveryThreshold;
+        const bool spaceLow = m_spaceLow;
+        QTimer::singleShot(0, worker, [=]() {
+            worker->watch(generation, devicePath, mountPath, lowSpaceThreshold, recoveryThreshold, spaceLow);
+        });
+    } else {
+        QTimer::singleShot(0, worker, [worker]() { worker->stop(); });
+    }
+}
+
+void PartitionSpaceMonitorPrivate::sampled(int generation, qint64 bytesTotal, qint64 bytesFree, qint64 bytesAvailable, bool spaceLow)
+{
+    Q_Q(PartitionSpaceMonitor);
+
+    if (generation != m_generation) {
+        return;
+    }
+
+    if (m_bytesTotal != bytesTotal || m_bytesFree != bytesFree || m_bytesAvailable != bytesAvailable) {
+        m_bytesTotal = bytesTotal;
+        m_bytesFree = bytesFree;
+        m_bytesAvailable = bytesAvailable;
+        emit q->bytesChanged();
+    }
+
+    if (m_spaceLow != spaceLow) {
+        m_spaceLow = spaceLow;
+        emit q->spaceLowChanged();
+        if (spaceLow) {
+            emit q->lowSpace();
+        } else {
+            emit q->spaceRecovered();
+        }
+    }
+}
+
+PartitionSpaceMonitor::PartitionSpaceMonitor(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new PartitionSpaceMonitorPrivate(this))
+{
+}
+
+PartitionSpaceMonitor::~PartitionSpaceMonitor()
+{
+}
+
+QString PartitionSpaceMonitor::mountPath() const
+{
+    Q_D(const PartitionSpaceMonitor);
+    return d->m_mountPath;
+}
+
+void PartitionSpaceMonitor::setMountPath(const QString &path)
+{
+    Q_D(PartitionSpaceMonitor);
+    if (d->m_mountPath != path) {
+        d->m_mountPath = path;
+        d->m_spaceLow = false;
+        emit mountPathChanged();
+        d->update(true);
+    }
+}
+
+bool PartitionSpaceMonitor::active() const
+{
+    Q_D(const PartitionSpaceMonitor);
+    return d->m_active;
+}
+
+void PartitionSpaceMonitor::setActive(bool active)
+{
+    Q_D(PartitionSpaceMonitor);
+    if (d->m_active != active) {
+        d->m_active = active;
+        emit activeChanged();
+        d->update(true);
+    }
+}
+
+qint64 PartitionSpaceMonitor::lowSpaceThreshold() const
+{
+    Q_D(const PartitionSpaceMonitor);
+    return d->m_lowSpaceThreshold;
+}
+
+void PartitionSpaceMonitor::setLowSpaceThreshold(qint64 threshold)
+{
+    Q_D(PartitionSpaceMonitor);
+    if (d->m_lowSpaceThreshold != threshold) {
+        d->m_lowSpaceThreshold = threshold;
+        emit lowSpaceThresholdChanged();
+        d->update(true);
+    }
+}
+
+qint64 PartitionSpaceMonitor::recoveryThreshold() const
+{
+    Q_D(const PartitionSpaceMonitor);
+    return d->m_recoveryThreshold;
+}
+
+void PartitionSpaceMonitor::setRecoveryThreshold(qint64 threshold)
+{
+    Q_D(PartitionSpaceMonitor);
+    if (d->m_recoveryThreshold != threshold) {
+        d->m_recoveryThreshold = threshold;
+        emit recoveryThresholdChanged();
+        d->update(true);
+    }
+}
+
+bool PartitionSpaceMonitor::spaceLow() const
+{
+    Q_D(const PartitionSpaceMonitor);
+    return d->m_spaceLow;
+}
+
+qint64 PartitionSpaceMonitor::bytesTotal() const
+{
+    Q_D(const PartitionSpaceMonitor);
+    return d->m_bytesTotal;
+}
+
+qint64 PartitionSpaceMonitor::bytesFree() const
+{
+    Q_D(const PartitionSpaceMonitor);
+    return d->m_bytesFree;
+}
+
+qint64 PartitionSpaceMonitor::bytesAvailable() const
+{
+    Q_D(const PartitionSpaceMonitor);
+    return d->m_bytesAvailable;
+}
+
+void PartitionSpaceMonitor::refresh()
+{
+    Q_D(PartitionSpaceMonitor);
+    d->update(true);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef PARTITIONSPACEMONITOR_H
+#define PARTITIONSPACEMONITOR_H
+
+#include <QObject>
+#include <QScopedPointer>
+
+#include <systemsettingsglobal.h>
+
+class PartitionSpaceMonitorPrivate;
+
+// Samples the free space of a mounted partition on a worker thread. The
+// sampling interval adapts to how fast the space is being consumed, and
+// lowSpace()/spaceRecovered() are emitted with hysteresis between the
+// two thresholds.
+class SYSTEMSETTINGS_EXPORT PartitionSpaceMonitor : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(PartitionSpaceMonitor)
+
+    Q_PROPERTY(QString mountPath READ mountPath WRITE setMountPath NOTIFY mountPathChanged)
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    // Thresholds are compared against bytesAvailable. A recovery threshold
+    // below the low space threshold is raised to it.
+    Q_PROPERTY(qint64 lowSpaceThreshold READ lowSpaceThreshold WRITE setLowSpaceThreshold NOTIFY lowSpaceThresholdChanged)
+    Q_PROPERTY(qint64 recoveryThreshold READ recoveryThreshold WRITE setRecoveryThreshold NOTIFY recoveryThresholdChanged)
+    Q_PROPERTY(bool spaceLow READ spaceLow NOTIFY spaceLowChanged)
+    Q_PROPERTY(qint64 bytesTotal READ bytesTotal NOTIFY bytesChanged)
+    Q_PROPERTY(qint64 bytesFree READ bytesFree NOTIFY bytesChanged)
+    Q_PROPERTY(qint64 bytesAvailable READ bytesAvailable NOTIFY bytesChanged)
+
+public:
+    explicit PartitionSpaceMonitor(QObject *parent = 0);
+    ~PartitionSpaceMonitor();
+
+    QString mountPath() const;
+    void setMountPath(const QString &path);
+
+    bool active() const;
+    void setActive(bool active);
+
+    qint64 lowSpaceThreshold() const;
+    void setLowSpaceThreshold(qint64 threshold);
+
+    qint64 recoveryThreshold() const;
+    void setRecoveryThreshold(qint64 threshold);
+
+    bool spaceLow() const;
+
+    qint64 bytesTotal() const;
+    qint64 bytesFree() const;
+    qint64 bytesAvailable() const;
+
+    Q_INVOKABLE void refresh();
+
+signals:
+    void mountPathChanged();
+    void activeChanged();
+    void lowSpaceThresholdChanged();
+    void recoveryThresholdChanged();
+    void spaceLowChanged();
+    void bytesChanged();
+
+    void lowSpace();
+    void spaceRecovered();
+
+private:
+    QScopedPointer<PartitionSpaceMonitorPrivate> const d_ptr;
+};
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef PARTITIONSPACEMONITOR_P_H
+#define PARTITIONSPACEMONITOR_P_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+class QTimer;
+
+class PartitionSpaceWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PartitionSpaceWorker(QObject *parent = 0);
+    ~PartitionSpaceWorker();
+
+    static int nextInterval(qint64 distance, qint64 consumed, qint64 elapsed);
+
+    static const int MinimumInterval = 1000;
+    static const int MaximumInterval = 30000;
+
+public slots:
+    void watch(int generation, const QString &devicePath, const QString &mountPath,
+               qint64 lowSpaceThreshold, qint64 recoveryThreshold, bool spaceLow);
+    void stop();
+    void sample();
+
+signals:
+    void sampled(int generation, qint64 bytesTotal, qint64 bytesFree, qint64 bytesAvailable, bool spaceLow);
+
+private:
+    QTimer *m_timer;
+    QElapsedTimer m_elapsed;
+    int m_generation;
+    QString m_devicePath;
+    QString m_mountPath;
+    qint64 m_lowSpaceThreshold;
+    qint64 m_recoveryThreshold;
+    qint64 m_lastAvailable;
+    bool m_spaceLow;
+};
+
+#endif
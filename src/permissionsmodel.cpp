@@ -32,15 +32,7 @@
 #include <MDesktopEntry>
 #include <MPermission>
 #include "permissionsmodel.h"
-
-namespace {
-
-bool permissionLessThan(const MPermission &p1, const MPermission &p2)
-{
-    return (p1.description().localeAwareCompare(p2.description()) < 0);
-}
-
-}
+#include "collationcache_p.h"
 
 PermissionsModel::PermissionsModel(QObject *parent)
     : QAbstractListModel(parent)
@@ -115,7 +107,11 @@ void PermissionsModel::loadPermissions()
         if (!permissions.isEmpty()) {
             beginInsertRows(QModelIndex(), 0, permissions.length() - 1);
             m_permissions.swap(permissions);
-            std::sort(m_permissions.begin(), m_permissions.end(), permissionLessThan);
+            CollationCache *collation = CollationCache::instance();
+            std::sort(m_permissions.begin(), m_permissions.end(),
+                      [collation](const MPermission &p1, const MPermission &p2) {
+                return collation->lessThan(p1.description(), p2.description());
+            });
             endInsertRows();
         }
     }
@@ -40,6 +40,7 @@
 
 #include "languagemodel.h"
 #include "datetimesettings.h"
+#include "timezonemodel.h"
 #include "profilecontrol.h"
 #include "alarmtonemodel.h"
 #include "displaysettings.h"
@@ -50,6 +51,7 @@
 #include "batterystatus.h"
 #include "diskusage.h"
 #include "partitionmodel.h"
+#include "partitionspacemonitor.h"
 #include "certificatemodel.h"
 #include "settingsvpnmodel.h"
 #include "locationsettings.h"
@@ -103,12 +105,14 @@ public:
         Q_ASSERT(QLatin1String(uri) == QLatin1String("org.nemomobile.systemsettings"));
         qmlRegisterType<LanguageModel>(uri, 1, 0, "LanguageModel");
         qmlRegisterType<DateTimeSettings>(uri, 1, 0, "DateTimeSettings");
+        qmlRegisterType<TimeZoneModel>(uri, 1, 0, "TimeZoneModel");
         qmlRegisterType<ProfileControl>(uri, 1, 0, "ProfileControl");
         qmlRegisterType<AlarmToneModel>(uri, 1, 0, "AlarmToneModel");
         qmlRegisterType<DisplaySettings>(uri, 1, 0, "DisplaySettings");
         qmlRegisterType<QUsbModed>(uri, 1, 0, "USBSettings");
         qmlRegisterType<AboutSettings>(uri, 1, 0, "AboutSettings");
         qmlRegisterType<PartitionModel>(uri, 1, 0, "PartitionModel");
+        qmlRegisterType<PartitionSpaceMonitor>(uri, 1, 0, "PartitionSpaceMonitor");
         qRegisterMetaType<Partition>("Partition");
 #ifdef DEVELOPER_MODE_ENABLED
         qmlRegisterType<DeveloperModeSettings>(uri, 1, 0, "DeveloperModeSettings");
@@ -66,6 +66,9 @@ int ProfileControl::s_instanceCounter = 0;
 
 ProfileControl::ProfileControl(QObject *parent)
     : QObject(parent),
+      m_ringerVolume(-1),
+      m_vibraInGeneral(false),
+      m_vibraInSilent(false),
       m_systemSoundLevel(-1),
       m_touchscreenToneLevel(-1),
       m_touchscreenVibrationLevel(-1),
@@ -90,9 +93,12 @@ ProfileControl::ProfileControl(QObject *parent)
     }
     s_instanceCounter++;
 
-    m_ringerVolume = profile_get_value_as_int(GeneralProfile, VolumeKey);
-    m_vibraInGeneral = profile_get_value_as_bool(GeneralProfile, VibraKey);
-    m_vibraInSilent = profile_get_value_as_bool(SilentProfile, VibraKey);
+    loadSnapshot(GeneralProfile);
+    loadSnapshot(SilentProfile);
+
+    if (m_ringerVolume == -1) {
+        m_ringerVolume = profile_get_value_as_int(GeneralProfile, VolumeKey);
+    }
 }
 
 ProfileControl::~ProfileControl()
@@ -521,6 +527,23 @@ void ProfileControl::setClockAlarmToneEnabled(bool enabled)
 }
 
 
+// Fetches every value of a profile in one round trip to profiled and feeds them through the
+// change handler, so the getters below only fall back to per-key queries for missing keys.
+void ProfileControl::loadSnapshot(const char *profile)
+{
+    profileval_t *values = profile_get_values(profile);
+    if (!values) {
+        qWarning() << "Unable to read values of profile" << profile;
+        return;
+    }
+
+    for (profileval_t *value = values; value->pv_key; ++value) {
+        updateStateCallBack(profile, value->pv_key, value->pv_val, value->pv_type);
+    }
+
+    profile_free_values(values);
+}
+
 void ProfileControl::currentProfileChangedCallback(const char *name, ProfileControl *profileControl)
 {
     QString newProfile = QString::fromUtf8(name);
@@ -542,7 +565,7 @@ void ProfileControl::updateStateCallBack(const char *profile, const char *key, c
                 emit ringerVolumeChanged();
             }
         } else if (qstrcmp(key, VibraKey) == 0) {
-            bool newVibra = (qstrcmp(val, "On") == 0);
+            bool newVibra = profile_parse_bool(val);
             if (newVibra != m_vibraInGeneral) {
                 m_vibraInGeneral = newVibra;
 
@@ -580,6 +603,12 @@ void ProfileControl::updateStateCallBack(const char *profile, const char *key, c
                 m_messageToneFile = newFile;
                 emit messageToneFileChanged();
             }
+        } else if (qstrcmp(key, ChatToneKey) == 0) {
+            QString newFile = val;
+            if (newFile != m_chatToneFile) {
+                m_chatToneFile = newFile;
+                emit chatToneFileChanged();
+            }
         } else if (qstrcmp(key, MailToneKey) == 0) {
             QString newFile = val;
             if (newFile != m_mailToneFile) {
@@ -652,9 +681,9 @@ void ProfileControl::updateStateCallBack(const char *profile, const char *key, c
 
     } else if (qstrcmp(profile, SilentProfile) == 0) {
         if (qstrcmp(key, VibraKey) == 0) {
-            bool newVibra = (qstrcmp(val, "On") == 0);
+            bool newVibra = profile_parse_bool(val);
             if (newVibra != m_vibraInSilent) {
-                m_vibraInGeneral = newVibra;
+                m_vibraInSilent = newVibra;
 
                 emit vibraModeChanged();
             }
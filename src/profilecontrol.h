@@ -219,6 +219,8 @@ private:
     int m_calendarToneEnabled;
     int m_clockAlarmToneEnabled;
 
+    void loadSnapshot(const char *profile);
+
     //! libprofile callback for profile changes
     static void currentProfileChangedCallback(const char *profile, ProfileControl *profileControl);
 
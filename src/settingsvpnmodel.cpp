@@ -40,6 +40,7 @@
 #include <QXmlResultItems>
 #include <QSettings>
 #include "logging_p.h"
+#include "collationcache_p.h"
 #include "vpnmanager.h"
 
 #include "settingsvpnmodel.h"
@@ -256,18 +257,19 @@ VpnConnection *SettingsVpnModel::get(int index) const
 // QAbstractListModel Ordering
 // ==========================================================================
 
-bool SettingsVpnModel::compareConnections(const VpnConnection *i, const VpnConnection *j)
+bool SettingsVpnModel::compareConnections(const VpnConnection *i, const VpnConnection *j, CollationCache *collation)
 {
     return ((orderByConnected_ && (i->connected() > j->connected()))
             || ((!orderByConnected_ || (i->connected() == j->connected()))
-                && (i->name().localeAwareCompare(j->name()) <= 0)));
+                && (collation->compare(i->name(), j->name()) <= 0)));
 }
 
 void SettingsVpnModel::orderConnections(QVector<VpnConnection*> &connections)
 {
-    std::sort(connections.begin(), connections.end(), [this](const VpnConnection *i, const VpnConnection *j) -> bool {
+    CollationCache *collation = CollationCache::instance();
+    std::sort(connections.begin(), connections.end(), [this, collation](const VpnConnection *i, const VpnConnection *j) -> bool {
         // Return true if i should appear before j in the list
-        return compareConnections(i, j);
+        return compareConnections(i, j, collation);
     });
 }
 
@@ -276,12 +278,13 @@ void SettingsVpnModel::reorderConnection(VpnConnection * conn)
     const int itemCount(connections().size());
 
     if (itemCount > 1) {
+        CollationCache *collation = CollationCache::instance();
         int index = 0;
         for ( ; index < itemCount; ++index) {
             const VpnConnection *existing = connections().at(index);
             // Scenario 1 orderByConnected == true: order first by connected, second by name
             // Scenario 2 orderByConnected == false: order only by name
-            if (!compareConnections(existing, conn)) {
+            if (!compareConnections(existing, conn, collation)) {
                 break;
             }
         }
@@ -41,6 +41,8 @@
 #include <vpnmodel.h>
 #include <systemsettingsglobal.h>
 
+class CollationCache;
+
 class SYSTEMSETTINGS_EXPORT SettingsVpnModel : public VpnModel
 {
     Q_OBJECT
@@ -96,7 +98,7 @@ private:
     QString createDefaultDomain() const;
     void reorderConnection(VpnConnection * conn);
     virtual void orderConnections(QVector<VpnConnection*> &connections) override;
-    bool compareConnections(const VpnConnection *i, const VpnConnection *j);
+    bool compareConnections(const VpnConnection *i, const VpnConnection *j, CollationCache *collation);
     QVariantMap processOpenVpnProvisioningFile(QFile &provisioningFile);
     QVariantMap processOpenconnectProvisioningFile(QFile &provisioningFile);
     QVariantMap processOpenfortivpnProvisioningFile(QFile &provisioningFile);
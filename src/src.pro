@@ -42,9 +42,11 @@ CONFIG(USE_SSU) {
 system($$[QT_INSTALL_BINS]/qdbusxml2cpp -p mceiface.h:mceiface.cpp mce.xml)
 
 SOURCES += \
+    languagecatalogue.cpp \
     languagemodel.cpp \
     localeconfig.cpp \
     logging.cpp \
+    mounttable.cpp \
     datetimesettings.cpp \
     nfcsettings.cpp \
     profilecontrol.cpp \
@@ -53,16 +55,24 @@ SOURCES += \
     displaysettings.cpp \
     aboutsettings.cpp \
     certificatemodel.cpp \
+    collationcache.cpp \
     batterystatus.cpp \
+    dbuscallstatistics.cpp \
     diskusage.cpp \
     diskusage_impl.cpp \
+    filesystemcapabilities.cpp \
+    iostatistics.cpp \
     partition.cpp \
     partitionmanager.cpp \
     partitionmodel.cpp \
+    partitionspacemonitor.cpp \
+    storagebenchmark.cpp \
     deviceinfo.cpp \
     locationsettings.cpp \
     settingsvpnmodel.cpp \
+    timezoneindex.cpp \
     timezoneinfo.cpp \
+    timezonemodel.cpp \
     udisks2block.cpp \
     udisks2blockdevices.cpp \
     udisks2job.cpp \
@@ -86,10 +96,12 @@ PUBLIC_HEADERS = \
     partition.h \
     partitionmanager.h \
     partitionmodel.h \
+    partitionspacemonitor.h \
     systemsettingsglobal.h \
     deviceinfo.h \
     locationsettings.h \
     timezoneinfo.h \
+    timezonemodel.h \
     permissionsmodel.h
 
 HEADERS += \
@@ -97,13 +109,23 @@ HEADERS += \
     aboutsettings_p.h \
     localeconfig.h \
     batterystatus_p.h \
+    collationcache_p.h \
     logging_p.h \
+    dbuscallstatistics_p.h \
     diskusage_p.h \
+    filesystemcapabilities_p.h \
+    iostatistics_p.h \
+    languagecatalogue_p.h \
     locationsettings_p.h \
     logging_p.h \
+    mounttable_p.h \
     nfcsettings.h \
     partition_p.h \
     partitionmanager_p.h \
+    partitionspacemonitor_p.h \
+    storagebenchmark_p.h \
+    timezoneindex_p.h \
+    timezoneinfo_p.h \
     udisks2blockdevices_p.h \
     udisks2job_p.h \
     udisks2monitor_p.h
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "storagebenchmark_p.h"
+#include "logging_p.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+const qint64 MaximumFileSize = 64 * 1024 * 1024;
+const qint64 MinimumFileSize = 8 * 1024 * 1024;
+const int SequentialBlockSize = 1024 * 1024;
+const int RandomBlockSize = 4096;
+const int RandomOperations = 2048;
+const qint64 RandomTimeLimit = 5000;   // milliseconds per random pass
+
+class TemporaryFile
+{
+public:
+    TemporaryFile(const QString &directory, quint32 suffix)
+    {
+        const QByteArray path = QStringLiteral("%1/.storage-benchmark-%2-%3")
+                .arg(directory)
+                .arg(::getpid())
+                .arg(suffix, 0, 16).toLocal8Bit();
+
+        m_direct = false;
+        m_fd = ::open(path.constData(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (m_fd == -1) {
+            m_error = QString::fromLocal8Bit(::strerror(errno));
+            return;
+        }
+        ::unlink(path.constData());
+
+        // Not every file system supports direct I/O, fall back to buffered
+        // I/O with explicit syncs and report it in the result. Opening with
+        // O_DIRECT would fail with EINVAL only after creating the file, so it
+        // is enabled on the already unlinked file instead.
+        const int flags = ::fcntl(m_fd, F_GETFL);
+        m_direct = flags != -1 && ::fcntl(m_fd, F_SETFL, flags | O_DIRECT) == 0;
+    }
+
+    ~TemporaryFile()
+    {
+        if (m_fd != -1) {
+            ::close(m_fd);
+        }
+    }
+
+    int fd() const { return m_fd; }
+    bool isDirect() const { return m_direct; }
+    QString errorString() const { return m_error; }
+
+    // Drops cached pages when direct I/O is not available.
+    void flush(qint64 size)
+    {
+        ::fdatasync(m_fd);
+        if (!m_direct) {
+            ::posix_fadvise(m_fd, 0, size, POSIX_FADV_DONTNEED);
+        }
+    }
+
+private:
+    int m_fd;
+    bool m_direct;
+    QString m_error;
+};
+
+}
+
+StorageBenchmarkWorker::StorageBenchmarkWorker(QObject *parent)
+    : QObject(parent)
+    , m_cancelled(0)
+{
+}
+
+StorageBenchmarkWorker::~StorageBenchmarkWorker()
+{
+}
+
+// SD association speed and video speed classes by minimum sequential write speed.
+// U1 has the same minimum as Class 10 but also requires a UHS bus, which a
+// file system benchmark cannot tell, so Class 10 is reported.
+QString StorageBenchmarkWorker::speedClass(qreal sequentialWriteSpeed)
+{
+    static const struct { qreal speed; const char *name; } classes[] = {
+        { 90, "V90" }, { 60, "V60" }, { 30, "U3" }, { 10, "Class 10" },
+        { 6, "Class 6" }, { 4, "Class 4" }, { 2, "Class 2" }
+    };
+    for (const auto &speedClass : classes) {
+        if (sequentialWriteSpeed >= speedClass.speed) {
+            return QString::fromLatin1(speedClass.name);
+        }
+    }
+    return QString();
+}
+
+// SD association application performance classes by minimum random 4K IOPS.
+QString StorageBenchmarkWorker::applicationClass(qreal randomReadIops, qreal randomWriteIops)
+{
+    if (randomReadIops >= 4000 && randomWriteIops >= 2000) {
+        return QStringLiteral("A2");
+    } else if (randomReadIops >= 1500 && randomWriteIops >= 500) {
+        return QStringLiteral("A1");
+    }
+    return QString();
+}
+
+void StorageBenchmarkWorker::run(const QString &devicePath, const QString &mountPath, qint64 bytesAvailable)
+{
+    QMutexLocker locker(&m_runMutex);
+
+    // Cancelled before the queued call got here.
+    if (isCancelled()) {
+        emit cancelled(devicePath);
+        return;
+    }
+
+    const qint64 fileSize = std::min(MaximumFileSize, bytesAvailable / 4) / SequentialBlockSize * SequentialBlockSize;
+    if (fileSize < MinimumFileSize) {
+        emit failed(devicePath, QStringLiteral("Not enough free space"));
+        return;
+    }
+
+    std::random_device seed;
+    std::mt19937_64 random(seed());
+    std::uniform_int_distribution<qint64> randomBlock(0, fileSize / RandomBlockSize - 1);
+
+    TemporaryFile file(mountPath, seed());
+    if (file.fd() == -1) {
+        emit failed(devicePath, file.errorString());
+        return;
+    }
+
+    void *buffer = nullptr;
+    if (::posix_memalign(&buffer, RandomBlockSize, SequentialBlockSize) != 0) {
+        emit failed(devicePath, QStringLiteral("Out of memory"));
+        return;
+    }
+    QScopedPointer<void, QScopedPointerPodDeleter> bufferCleanup(buffer);
+    ::memset(buffer, 0xa5, SequentialBlockSize);
+
+    const qint64 blocks = fileSize / SequentialBlockSize;
+    // Four passes with roughly equal weight in the progress.
+    const qreal passWeight = 0.25;
+    QElapsedTimer timer;
+    QVariantMap result;
+
+    auto ioFailed = [this, &devicePath]() {
+        emit failed(devicePath, QString::fromLocal8Bit(::strerror(errno)));
+    };
+
+    // Sequential write, including the final sync.
+    timer.start();
+    for (qint64 i = 0; i < blocks; ++i) {
+        if (isCancelled()) {
+            emit cancelled(devicePath);
+            return;
+        }
+        if (::pwrite(file.fd(), buffer, SequentialBlockSize, i * SequentialBlockSize) != SequentialBlockSize) {
+            ioFailed();
+            return;
+        }
+        emit progress(devicePath, passWeight * (i + 1) / blocks);
+    }
+    file.flush(fileSize);
+    const qreal sequentialWriteSpeed = qreal(fileSize) / 1e6 / std::max<qint64>(timer.elapsed(), 1) * 1000;
+
+    // Sequential read.
+    timer.restart();
+    for (qint64 i = 0; i < blocks; ++i) {
+        if (isCancelled()) {
+            emit cancelled(devicePath);
+            return;
+        }
+        if (::pread(file.fd(), buffer, SequentialBlockSize, i * SequentialBlockSize) != SequentialBlockSize) {
+            ioFailed();
+            return;
+        }
+        emit progress(devicePath, passWeight * (1 + qreal(i + 1) / blocks));
+    }
+    const qreal sequentialReadSpeed = qreal(fileSize) / 1e6 / std::max<qint64>(timer.elapsed(), 1) * 1000;
+
+    // Random 4K writes, bounded by both count and time.
+    int operations = 0;
+    timer.restart();
+    for (; operations < RandomOperations && timer.elapsed() < RandomTimeLimit; ++operations) {
+        if (isCancelled()) {
+            emit cancelled(devicePath);
+            return;
+        }
+        const qint64 offset = randomBlock(random) * RandomBlockSize;
+        if (::pwrite(file.fd(), buffer, RandomBlockSize, offset) != RandomBlockSize) {
+            ioFailed();
+            return;
+        }
+        if (operations % 64 == 0) {
+            emit progress(devicePath, passWeight * (2 + qreal(operations) / RandomOperations));
+        }
+    }
+    file.flush(fileSize);
+    const qreal randomWriteIops = qreal(operations) / std::max<qint64>(timer.elapsed(), 1) * 1000;
+
+    // Random 4K reads.
+    operations = 0;
+    timer.restart();
+    for (; operations < RandomOperations && timer.elapsed() < RandomTimeLimit; ++operations) {
+        if (isCancelled()) {
+            emit cancelled(devicePath);
+            return;
+        }
+        const qint64 offset = randomBlock(random) * RandomBlockSize;
+        if (::pread(file.fd(), buffer, RandomBlockSize, offset) != RandomBlockSize) {
+            ioFailed();
+            return;
+        }
+        if (operations % 64 == 0) {
+            emit progress(devicePath, passWeight * (3 + qreal(operations) / RandomOperations));
+        }
+    }
+    const qreal randomReadIops = qreal(operations) / std::max<qint64>(timer.elapsed(), 1) * 1000;
+
+    result.insert(QStringLiteral("sequentialReadSpeed"), sequentialReadSpeed);
+    result.insert(QStringLiteral("sequentialWriteSpeed"), sequentialWriteSpeed);
+    result.insert(QStringLiteral("randomReadIops"), randomReadIops);
+    result.insert(QStringLiteral("randomWriteIops"), randomWriteIops);
+    result.insert(QStringLiteral("speedClass"), speedClass(sequentialWriteSpeed));
+    result.insert(QStringLiteral("applicationClass"), applicationClass(randomReadIops, randomWriteIops));
+    result.insert(QStringLiteral("directIo"), file.isDirect());
+    result.insert(QStringLiteral("fileSize"), fileSize);
+
+    qCInfo(lcMemoryCardLog) << "Storage benchmark of" << devicePath << result;
+
+    emit progress(devicePath, 1);
+    emit finished(devicePath, result);
+}
+
+StorageBenchmark::StorageBenchmark(QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread())
+    , m_worker(new StorageBenchmarkWorker())
+    , m_running(false)
+{
+    m_worker->moveToThread(m_thread);
+
+    connect(this, &StorageBenchmark::run, m_worker, &StorageBenchmarkWorker::run);
+    connect(m_worker, &StorageBenchmarkWorker::progress, this, &StorageBenchmark::progress);
+    connect(m_worker, &StorageBenchmarkWorker::finished, this, [this](const QString &devicePath, const QVariantMap &result) {
+        setRunning(false);
+        emit finished(devicePath, result);
+    });
+    connect(m_worker, &StorageBenchmarkWorker::failed, this, [this](const QString &devicePath, const QString &message) {
+        setRunning(false);
+        emit failed(devicePath, message);
+    });
+    connect(m_worker, &StorageBenchmarkWorker::cancelled, this, [this](const QString &devicePath) {
+        setRunning(false);
+        emit cancelled(devicePath);
+    });
+
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+
+    m_thread->start(QThread::LowPriority);
+}
+
+StorageBenchmark::~StorageBenchmark()
+{
+    m_worker->setCancelled(true);
+    m_thread->quit();
+}
+
+bool StorageBenchmark::isRunning() const
+{
+    return m_running;
+}
+
+QString StorageBenchmark::devicePath() const
+{
+    return m_running ? m_devicePath : QString();
+}
+
+void StorageBenchmark::start(const QString &devicePath, const QString &mountPath, qint64 bytesAvailable)
+{
+    if (m_running) {
+        qCWarning(lcMemoryCardLog) << "Storage benchmark already running, ignoring" << devicePath;
+        emit failed(devicePath, QStringLiteral("Benchmark already running"));
+        return;
+    }
+
+    m_devicePath = devicePath;
+    m_worker->setCancelled(false);
+    setRunning(true);
+    emit run(devicePath, mountPath, bytesAvailable);
+}
+
+// Completes asynchronously with cancelled().
+void StorageBenchmark::cancel()
+{
+    if (m_running) {
+        m_worker->setCancelled(true);
+    }
+}
+
+// Stops the I/O before returning, the file held open on the mount is closed
+// once this returns. cancelled() is still emitted asynchronously.
+void StorageBenchmark::cancelAndWait()
+{
+    if (m_running) {
+        m_worker->setCancelled(true);
+        m_worker->waitForIdle();
+    }
+}
+
+void StorageBenchmark::setRunning(bool running)
+{
+    if (m_running != running) {
+        m_running = running;
+        emit runningChanged();
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef STORAGEBENCHMARK_P_H
+#define STORAGEBENCHMARK_P_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVariantMap>
+
+class QThread;
+
+class StorageBenchmarkWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StorageBenchmarkWorker(QObject *parent = 0);
+    ~StorageBenchmarkWorker();
+
+    // Called from the owning thread, checked between I/O operations.
+    void setCancelled(bool cancelled) { m_cancelled.storeRelease(cancelled); }
+    // Called from the owning thread, blocks until run() has returned.
+    void waitForIdle() { QMutexLocker locker(&m_runMutex); }
+
+    static QString speedClass(qreal sequentialWriteSpeed);
+    static QString applicationClass(qreal randomReadIops, qreal randomWriteIops);
+
+public slots:
+    void run(const QString &devicePath, const QString &mountPath, qint64 bytesAvailable);
+
+signals:
+    void progress(const QString &devicePath, qreal progress);
+    void finished(const QString &devicePath, const QVariantMap &result);
+    void failed(const QString &devicePath, const QString &message);
+    void cancelled(const QString &devicePath);
+
+private:
+    bool isCancelled() const { return m_cancelled.loadAcquire(); }
+
+    QAtomicInt m_cancelled;
+    QMutex m_runMutex;
+};
+
+// Runs one bounded read/write benchmark at a time in a temporary file on
+// a mounted partition. The file is unlinked as soon as it is opened so it
+// never outlives the benchmark, even if the process dies.
+class StorageBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StorageBenchmark(QObject *parent = 0);
+    ~StorageBenchmark();
+
+    bool isRunning() const;
+    QString devicePath() const;
+
+    void start(const QString &devicePath, const QString &mountPath, qint64 bytesAvailable);
+    void cancel();
+    void cancelAndWait();
+
+signals:
+    void runningChanged();
+    void progress(const QString &devicePath, qreal progress);
+    void finished(const QString &devicePath, const QVariantMap &result);
+    void failed(const QString &devicePath, const QString &message);
+    void cancelled(const QString &devicePath);
+
+    void run(const QString &devicePath, const QString &mountPath, qint64 bytesAvailable);
+
+private:
+    void setRunning(bool running);
+
+    QThread *m_thread;
+    StorageBenchmarkWorker *m_worker;
+    QString m_devicePath;
+    bool m_running;
+};
+
+#endif
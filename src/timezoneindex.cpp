@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "timezoneindex_p.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+const char Magic[8] = { 'N', 'E', 'M', 'O', 'T', 'Z', 'I', 'X' };
+const quint32 FormatVersion = 2;
+const quint32 ByteOrderMark = 0x01020304;
+
+struct Header
+{
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    quint32 stampSize;          // padded to a multiple of eight, follows the header
+    quint32 count;              // records follow the stamp
+    quint32 transitionCount;    // transitions follow the records
+    quint32 stringsSize;        // string pool follows the transitions
+};
+
+quint32 padded(quint32 size)
+{
+    return (size + 7) & ~7u;
+}
+
+class StringPool
+{
+public:
+    StringPool()
+    {
+        add(QByteArray());
+    }
+
+    quint32 add(const QByteArray &string)
+    {
+        auto it = m_offsets.constFind(string);
+        if (it != m_offsets.constEnd()) {
+            return *it;
+        }
+        const quint32 offset = m_data.size();
+        m_data.append(string.constData(), string.size());
+        m_data.append('\0');
+        m_offsets.insert(string, offset);
+        return offset;
+    }
+
+    const QByteArray &data() const { return m_data; }
+
+private:
+    QByteArray m_data;
+    QHash<QByteArray, quint32> m_offsets;
+};
+
+qint64 floorDivide(qint64 value, qint64 divisor)
+{
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date.
+qint64 daysFromCivil(qint64 year, int month, int day)
+{
+    year -= month <= 2;
+    const qint64 era = floorDivide(year, 400);
+    const qint64 yearOfEra = year - era * 400;
+    const qint64 dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const qint64 dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+qint64 yearFromDays(qint64 days)
+{
+    days += 719468;
+    const qint64 era = floorDivide(days, 146097);
+    const qint64 dayOfEra = days - era * 146097;
+    const qint64 yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const qint64 dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const qint64 shiftedMonth = (5 * dayOfYear + 2) / 153;     // March is zero
+    return yearOfEra + era * 400 + (shiftedMonth >= 10 ? 1 : 0);
+}
+
+bool isLeapYear(qint64 year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+bool parseNumber(const char *&ch, int maximum, int *value)
+{
+    if (!isdigit(uchar(*ch))) {
+        return false;
+    }
+    *value = 0;
+    while (isdigit(uchar(*ch))) {
+        *value = *value * 10 + (*ch++ - '0');
+        if (*value > maximum) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// [+-]hh[:mm[:ss]], hours may go up to 167 in TZif v3 rules.
+bool parseTime(const char *&ch, qint32 *seconds)
+{
+    int sign = 1;
+    if (*ch == '+' || *ch == '-') {
+        sign = *ch++ == '-' ? -1 : 1;
+    }
+
+    int hours = 0;
+    int minutes = 0;
+    int secs = 0;
+    if (!parseNumber(ch, 167, &hours)) {
+        return false;
+    }
+    if (*ch == ':') {
+        ++ch;
+        if (!parseNumber(ch, 59, &minutes)) {
+            return false;
+        }
+        if (*ch == ':') {
+            ++ch;
+            if (!parseNumber(ch, 59, &secs)) {
+                return false;
+            }
+        }
+    }
+
+    *seconds = sign * (hours * 3600 + minutes * 60 + secs);
+    return true;
+}
+
+// Alphabetic zone abbreviation of three or more characters or a quoted <...> one.
+bool skipName(const char *&ch)
+{
+    if (*ch == '<') {
+        const char *end = strchr(ch, '>');
+        if (!end) {
+            return false;
+        }
+        ch = end + 1;
+        return true;
+    }
+
+    const char *start = ch;
+    while (isalpha(uchar(*ch))) {
+        ++ch;
+    }
+    return ch - start >= 3;
+}
+
+struct RuleDate
+{
+    char type;                  // 'J' Julian day without Feb 29, 'N' zero based day, 'M' month.week.weekday
+    int day;
+    int month;
+    int week;
+    qint32 time;                // local time of day of the change
+};
+
+bool parseDate(const char *&ch, RuleDate *date)
+{
+    date->day = date->month = date->week = 0;
+    if (*ch == 'J') {
+        ++ch;
+        date->type = 'J';
+        if (!parseNumber(ch, 365, &date->day) || date->day < 1) {
+            return false;
+        }
+    } else if (*ch == 'M') {
+        ++ch;
+        date->type = 'M';
+        if (!parseNumber(ch, 12, &date->month) || date->month < 1 || *ch++ != '.'
+                || !parseNumber(ch, 5, &date->week) || date->week < 1 || *ch++ != '.'
+                || !parseNumber(ch, 6, &date->day)) {
+            return false;
+        }
+    } else {
+        date->type = 'N';
+        if (!parseNumber(ch, 365, &date->day)) {
+            return false;
+        }
+    }
+
+    date->time = 2 * 3600;
+    if (*ch == '/') {
+        ++ch;
+        return parseTime(ch, &date->time);
+    }
+    return true;
+}
+
+// Local seconds since the epoch at which the rule date occurs in the given year.
+qint64 ruleTime(const RuleDate &date, qint64 year)
+{
+    qint64 day;
+    if (date.type == 'J') {
+        day = daysFromCivil(year, 1, 1) + date.day - 1 + (isLeapYear(year) && date.day >= 60 ? 1 : 0);
+    } else if (date.type == 'N') {
+        day = daysFromCivil(year, 1, 1) + date.day;
+    } else {
+        const qint64 first = daysFromCivil(year, date.month, 1);
+        const qint64 next = date.month == 12 ? daysFromCivil(year + 1, 1, 1) : daysFromCivil(year, date.month + 1, 1);
+        const int weekday = int(first + 4 - floorDivide(first + 4, 7) * 7);      // 1970-01-01 was a Thursday
+        day = first + (date.day - weekday + 7) % 7 + (date.week - 1) * 7;
+        while (day >= next) {
+            day -= 7;
+        }
+    }
+    return day * 86400 + date.time;
+}
+
+}
+
+TimeZoneIndex::TimeZoneIndex()
+    : m_records(nullptr)
+    , m_transitions(nullptr)
+    , m_strings(nullptr)
+    , m_count(0)
+{
+}
+
+TimeZoneIndex::~TimeZoneIndex()
+{
+}
+
+bool TimeZoneIndex::open(const QString &fileName, const QByteArray &stamp)
+{
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    const uchar *data = size >= qint64(sizeof(Header)) ? m_file.map(0, size) : nullptr;
+    if (!data || !setData(data, size, stamp)) {
+        m_file.close();   // also unmaps
+        return false;
+    }
+    return true;
+}
+
+bool TimeZoneIndex::load(const QByteArray &data, const QByteArray &stamp)
+{
+    m_buffer = data;
+    if (!setData(reinterpret_cast<const uchar *>(m_buffer.constData()), m_buffer.size(), stamp)) {
+        m_buffer.clear();
+        return false;
+    }
+    return true;
+}
+
+bool TimeZoneIndex::setData(const uchar *data, qint64 size, const QByteArray &stamp)
+{
+    if (size < qint64(sizeof(Header))) {
+        return false;
+    }
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+
+    const quint64 recordsStart = sizeof(Header) + quint64(padded(header.stampSize));
+    const quint64 transitionsStart = recordsStart + quint64(header.count) * sizeof(Record);
+    const quint64 stringsStart = transitionsStart + quint64(header.transitionCount) * sizeof(Transition);
+    const bool valid = memcmp(header.magic, Magic, sizeof(Magic)) == 0
+            && header.formatVersion == FormatVersion
+            && header.byteOrder == ByteOrderMark
+            && header.stampSize == quint32(stamp.size())
+            && stringsStart + header.stringsSize == quint64(size)
+            && header.stringsSize > 0
+            && memcmp(data + sizeof(Header), stamp.constData(), stamp.size()) == 0
+            && data[size - 1] == '\0';
+    if (!valid) {
+        return false;
+    }
+
+    const Record *records = reinterpret_cast<const Record *>(data + recordsStart);
+    for (quint32 i = 0; i < header.count; ++i) {
+        const Record &record = records[i];
+        if (record.name >= header.stringsSize
+                || record.area >= header.stringsSize
+                || record.city >= header.stringsSize
+                || record.countryCode >= header.stringsSize
+                || record.countryName >= header.stringsSize
+                || record.comments >= header.stringsSize
+                || record.rule >= header.stringsSize
+                || quint64(record.firstTransition) + record.transitionCount > header.transitionCount) {
+            return false;
+        }
+    }
+
+    m_stamp = stamp;
+    m_records = records;
+    m_transitions = reinterpret_cast<const Transition *>(data + transitionsStart);
+    m_strings = reinterpret_cast<const char *>(data + stringsStart);
+    m_count = header.count;
+
+    m_handles.resize(m_count);
+    for (int i = 0; i < m_count; ++i) {
+        m_handles[i].index = this;
+        m_handles[i].record = i;
+    }
+    return true;
+}
+
+TimeZoneIndex::LocalTime TimeZoneIndex::localTimeAt(int index, qint64 time) const
+{
+    const Record &zone = m_records[index];
+    const Transition *begin = m_transitions + zone.firstTransition;
+    const Transition *end = begin + zone.transitionCount;
+
+    const Transition *next = std::upper_bound(begin, end, time, [](qint64 time, const Transition &transition) {
+        return time < transition.time;
+    });
+
+    if (next == end && m_strings[zone.rule]) {
+        LocalTime localTime;
+        if (evaluateRule(m_strings + zone.rule, time, &localTime)) {
+            return localTime;
+        }
+    }
+
+    return next == begin ? zone.initial : (next - 1)->localTime;
+}
+
+// Evaluates a POSIX TZ string such as "CET-1CEST,M3.5.0,M10.5.0/3". Returns
+// false if the rule cannot be parsed.
+bool TimeZoneIndex::evaluateRule(const char *rule, qint64 time, LocalTime *localTime)
+{
+    const char *ch = rule;
+
+    qint32 standardOffset;
+    if (!skipName(ch) || !parseTime(ch, &standardOffset)) {
+        return false;
+    }
+    standardOffset = -standardOffset;   // POSIX offsets are west of UTC
+
+    if (!*ch) {
+        localTime->offset = standardOffset;
+        localTime->isDst = 0;
+        return true;
+    }
+
+    if (!skipName(ch)) {
+        return false;
+    }
+
+    qint32 dstOffset = standardOffset + 3600;
+    if (*ch && *ch != ',') {
+        if (!parseTime(ch, &dstOffset)) {
+            return false;
+        }
+        dstOffset = -dstOffset;
+    }
+
+    RuleDate start;
+    RuleDate end;
+    if (*ch++ != ',' || !parseDate(ch, &start) || *ch++ != ',' || !parseDate(ch, &end) || *ch) {
+        return false;
+    }
+
+    // DST starts at a standard local time and ends at a daylight local time.
+    const qint64 year = yearFromDays(floorDivide(time + standardOffset, 86400));
+    const qint64 dstStart = ruleTime(start, year) - standardOffset;
+    const qint64 dstEnd = ruleTime(end, year) - dstOffset;
+
+    const bool dst = dstStart < dstEnd
+            ? time >= dstStart && time < dstEnd
+            : time < dstEnd || time >= dstStart;       // southern hemisphere
+
+    localTime->offset = dst ? dstOffset : standardOffset;
+    localTime->isDst = dst;
+    return true;
+}
+
+QByteArray TimeZoneIndex::build(const QByteArray &stamp, const QVector<Zone> &zones)
+{
+    StringPool strings;
+    QVector<Record> records;
+    QVector<Transition> transitions;
+    records.reserve(zones.count());
+    for (const Zone &zone : zones) {
+        Record record;
+        record.name = strings.add(zone.name);
+        record.area = strings.add(zone.area);
+        record.city = strings.add(zone.city);
+        record.countryCode = strings.add(zone.countryCode);
+        record.countryName = strings.add(zone.countryName);
+        record.comments = strings.add(zone.comments);
+        record.offset = zone.offset;
+        record.initial = zone.initial;
+        record.rule = strings.add(zone.rule);
+        record.firstTransition = transitions.count();
+        record.transitionCount = zone.transitions.count();
+        transitions += zone.transitions;
+        records.append(record);
+    }
+
+    Header header;
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.formatVersion = FormatVersion;
+    header.byteOrder = ByteOrderMark;
+    header.stampSize = stamp.size();
+    header.count = records.count();
+    header.transitionCount = transitions.count();
+    header.stringsSize = strings.data().size();
+
+    QByteArray data;
+    data.reserve(sizeof(header) + padded(stamp.size()) + records.count() * sizeof(Record)
+                 + transitions.count() * sizeof(Transition) + strings.data().size());
+    data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    data.append(stamp);
+    data.append(QByteArray(padded(stamp.size()) - stamp.size(), '\0'));
+    data.append(reinterpret_cast<const char *>(records.constData()), records.count() * sizeof(Record));
+    data.append(reinterpret_cast<const char *>(transitions.constData()), transitions.count() * sizeof(Transition));
+    data.append(strings.data());
+    return data;
+}
+
+bool TimeZoneIndex::save(const QString &fileName, const QByteArray &data)
+{
+    if (!QDir().mkpath(QFileInfo(fileName).absolutePath())) {
+        return false;
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write timezone index:" << fileName << file.errorString();
+        return false;
+    }
+
+    file.write(data);
+
+    if (!file.commit()) {
+        qWarning() << "Cannot write timezone index:" << fileName << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString TimeZoneIndex::cacheFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QStringLiteral("/nemo-systemsettings/timezones.index");
+}
+
+// Identifies the installed tzdata by its version and the modification
+// times of the tables the index is built from and of the zoneinfo directory.
+QByteArray TimeZoneIndex::tzdataStamp(const QString &zoneInfoPath)
+{
+    QByteArray stamp;
+
+    QFile versionFile(zoneInfoPath + QStringLiteral("tzdata.zi"));
+    if (versionFile.open(QIODevice::ReadOnly)) {
+        // "# version 2024a"
+        stamp = versionFile.readLine(64).trimmed();
+    }
+
+    for (const QString &table : { QStringLiteral("zone.tab"), QStringLiteral("iso3166.tab"), QString() }) {
+        const QFileInfo info(zoneInfoPath + table);
+        stamp += ' ';
+        stamp += QByteArray::number(info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0);
+    }
+
+    return stamp;
+}
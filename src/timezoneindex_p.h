@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef TIMEZONEINDEX_P_H
+#define TIMEZONEINDEX_P_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QSharedData>
+#include <QVector>
+
+class TimeZoneIndex;
+
+// One zone of an index, owned by and living as long as the index.
+struct TimeZoneHandle
+{
+    TimeZoneIndex *index;
+    int record;
+};
+
+// Binary cache of the parsed zone.tab, iso3166.tab and TZif data. The file
+// holds a header, an array of fixed size records, the transitions of all
+// zones and a pool of NUL terminated strings the records point into. It is
+// built once per tzdata version and memory mapped on later loads.
+class TimeZoneIndex : public QSharedData
+{
+public:
+    struct LocalTime
+    {
+        qint32 offset;          // seconds east of UTC
+        qint32 isDst;
+    };
+
+    struct Transition
+    {
+        qint64 time;            // seconds since the epoch, UTC
+        LocalTime localTime;
+    };
+
+    struct Record
+    {
+        quint32 name;
+        quint32 area;
+        quint32 city;
+        quint32 countryCode;
+        quint32 countryName;
+        quint32 comments;
+        qint32 offset;          // last standard time offset
+        LocalTime initial;      // before the first transition
+        quint32 rule;           // POSIX TZ string for times after the last transition
+        quint32 firstTransition;
+        quint32 transitionCount;
+    };
+
+    // Parsed form of a zone, used while building an index.
+    struct Zone
+    {
+        Zone() : offset(0), valid(false) { initial.offset = 0; initial.isDst = 0; }
+
+        QByteArray name;
+        QByteArray area;
+        QByteArray city;
+        QByteArray countryCode;
+        QByteArray countryName;
+        QByteArray comments;
+        qint32 offset;
+        LocalTime initial;
+        QVector<Transition> transitions;
+        QByteArray rule;
+        bool valid;
+    };
+
+    TimeZoneIndex();
+    ~TimeZoneIndex();
+
+    QByteArray stamp() const { return m_stamp; }
+
+    bool open(const QString &fileName, const QByteArray &stamp);
+    bool load(const QByteArray &data, const QByteArray &stamp);
+
+    int count() const { return m_count; }
+    const Record &record(int index) const { return m_records[index]; }
+    const char *string(quint32 offset) const { return m_strings + offset; }
+    const TimeZoneHandle *handle(int index) const { return &m_handles[index]; }
+
+    LocalTime localTimeAt(int index, qint64 time) const;
+
+    static QByteArray build(const QByteArray &stamp, const QVector<Zone> &zones);
+    static bool save(const QString &fileName, const QByteArray &data);
+
+    static QString cacheFileName();
+    static QByteArray tzdataStamp(const QString &zoneInfoPath);
+
+    static bool evaluateRule(const char *rule, qint64 time, LocalTime *localTime);
+
+private:
+    Q_DISABLE_COPY(TimeZoneIndex)
+
+    bool setData(const uchar *data, qint64 size, const QByteArray &stamp);
+
+    QFile m_file;
+    QByteArray m_buffer;
+    QByteArray m_stamp;
+    const Record *m_records;
+    const Transition *m_transitions;
+    const char *m_strings;
+    QVector<TimeZoneHandle> m_handles;
+    int m_count;
+};
+
+#endif
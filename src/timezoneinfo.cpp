@@ -30,12 +30,22 @@
  */
 
 #include "timezoneinfo.h"
+#include "timezoneinfo_p.h"
 
 #include <sys/time.h>
 
+#include <QDateTime>
 #include <QDebug>
 #include <QFile>
-#include <QDataStream>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QVarLengthArray>
+#include <QVector>
+#include <QtEndian>
+
+#include <cstring>
 
 namespace {
 
@@ -95,39 +105,68 @@ static QHash<QByteArray,QByteArray> parseIso3166()
 
 }
 
-class TimeZoneInfoPrivate
+namespace {
+
+// Parses TZif files for the zones claimed from a shared counter until none are left.
+class ZoneInfoParser : public QRunnable
 {
 public:
-    TimeZoneInfoPrivate();
-    ~TimeZoneInfoPrivate();
-
-    static QList<TimeZoneInfo> parseZoneTab();
-    static void parseZoneTabLine(const QByteArray &line, TimeZoneInfo *tzInfo);
-    static void parseZoneInfo(TimeZoneInfo *tzInfo);
-
-    QByteArray name;
-    QByteArray area;
-    QByteArray city;
-    QByteArray countryCode;
-    QByteArray countryName;
-    QByteArray comments;
-    qint32 offset;
-    bool valid;
+    ZoneInfoParser(TimeZoneIndex::Zone *zones, int count, QAtomicInt *next)
+        : m_zones(zones)
+        , m_count(count)
+        , m_next(next)
+    {
+    }
+
+    void run() override
+    {
+        for (int i = m_next->fetchAndAddRelaxed(1); i < m_count; i = m_next->fetchAndAddRelaxed(1)) {
+            TimeZoneInfoPrivate::parseZoneInfo(&m_zones[i]);
+        }
+    }
+
+private:
+    TimeZoneIndex::Zone *m_zones;
+    const int m_count;
+    QAtomicInt *m_next;
 };
 
-TimeZoneInfoPrivate::TimeZoneInfoPrivate()
-    : offset(0)
-    , valid(false)
-{
 }
 
-TimeZoneInfoPrivate::~TimeZoneInfoPrivate()
+QList<TimeZoneInfo> TimeZoneInfoPrivate::systemTimeZones()
 {
+    static QMutex mutex;
+    static QExplicitlySharedDataPointer<TimeZoneIndex> index;
+
+    QMutexLocker locker(&mutex);
+
+    // Zones handed out earlier keep the index they were created from alive.
+    const QByteArray stamp = TimeZoneIndex::tzdataStamp(ZoneInfoPath);
+    if (!index || index->stamp() != stamp) {
+        QExplicitlySharedDataPointer<TimeZoneIndex> updated(new TimeZoneIndex);
+        const QString fileName = TimeZoneIndex::cacheFileName();
+        if (!updated->open(fileName, stamp)) {
+            const QByteArray data = TimeZoneIndex::build(stamp, parseZoneTab());
+            // Without a writable cache the index is only kept in memory.
+            if (!TimeZoneIndex::save(fileName, data) || !updated->open(fileName, stamp)) {
+                updated->load(data, stamp);
+            }
+        }
+        index = updated;
+    }
+
+    QList<TimeZoneInfo> timeZones;
+    timeZones.reserve(index->count());
+    for (int i = 0; i < index->count(); ++i) {
+        timeZones.append(TimeZoneInfo(index.data(), i));
+    }
+
+    return timeZones;
 }
 
-QList<TimeZoneInfo> TimeZoneInfoPrivate::parseZoneTab()
+QVector<TimeZoneIndex::Zone> TimeZoneInfoPrivate::parseZoneTab()
 {
-    QList<TimeZoneInfo> timeZones;
+    QVector<TimeZoneIndex::Zone> timeZones;
     QHash<QByteArray,QByteArray> countries = parseIso3166();
 
     QFile file(ZoneInfoPath + QStringLiteral("zone.tab"));
@@ -137,6 +176,7 @@ QList<TimeZoneInfo> TimeZoneInfoPrivate::parseZoneTab()
         return timeZones;
     }
 
+    QVector<TimeZoneIndex::Zone> candidates;
     while (!file.atEnd()) {
         QByteArray line = file.readLine();
         if (line.length() == 0)
@@ -144,21 +184,40 @@ QList<TimeZoneInfo> TimeZoneInfoPrivate::parseZoneTab()
         if (line[0] == '#')
             continue;
 
-        TimeZoneInfo tz;
-        parseZoneTabLine(line, &tz);
-        parseZoneInfo(&tz);
-        if (tz.isValid()) {
-            tz.d->countryName = countries.value(tz.d->countryCode);
-            timeZones.append(tz);
+        TimeZoneIndex::Zone zone;
+        parseZoneTabLine(line, &zone);
+        if (zone.valid) {
+            candidates.append(zone);
+        }
+    }
+
+    // The TZif files are independent, parse them on all cores. The calling
+    // thread takes part so the work also completes without free pool threads.
+    QAtomicInt next;
+    TimeZoneIndex::Zone *zones = candidates.data();
+    const int count = candidates.count();
+
+    QThreadPool pool;
+    for (int i = 1; i < qMin(pool.maxThreadCount(), count); ++i) {
+        pool.start(new ZoneInfoParser(zones, count, &next));
+    }
+    ZoneInfoParser(zones, count, &next).run();
+    pool.waitForDone();
+
+    timeZones.reserve(count);
+    for (TimeZoneIndex::Zone &zone : candidates) {
+        if (zone.valid) {
+            zone.countryName = countries.value(zone.countryCode);
+            timeZones.append(zone);
         }
     }
 
     return timeZones;
 }
 
-void TimeZoneInfoPrivate::parseZoneTabLine(const QByteArray &line, TimeZoneInfo *tzInfo)
+void TimeZoneInfoPrivate::parseZoneTabLine(const QByteArray &line, TimeZoneIndex::Zone *zone)
 {
-    if (!tzInfo) {
+    if (!zone) {
         return;
     }
     int column = 0;
@@ -166,7 +225,7 @@ void TimeZoneInfoPrivate::parseZoneTabLine(const QByteArray &line, TimeZoneInfo
     while (*ch && *ch != '\n') {
         switch (column) {
         case 0:
-            tzInfo->d->countryCode = scanWord(ch);
+            zone->countryCode = scanWord(ch);
             skipSpace(ch);
             break;
         case 1:
@@ -175,178 +234,282 @@ void TimeZoneInfoPrivate::parseZoneTabLine(const QByteArray &line, TimeZoneInfo
             skipSpace(ch);
             break;
         case 2:
-            tzInfo->d->name = scanWord(ch);
+            zone->name = scanWord(ch);
             skipSpace(ch);
             break;
         case 3:
-            tzInfo->d->comments = scanToEnd(ch);
+            zone->comments = scanToEnd(ch);
             break;
         }
         ++column;
     }
-    tzInfo->d->valid = column > 2;
+    zone->valid = column > 2;
 
-    if (tzInfo->d->valid) {
-        int slash = tzInfo->d->name.lastIndexOf('/');
+    if (zone->valid) {
+        int slash = zone->name.lastIndexOf('/');
         if (slash > 0) {
-            tzInfo->d->area = tzInfo->d->name.left(slash);
-            tzInfo->d->city = tzInfo->d->name.mid(slash+1);
+            zone->area = zone->name.left(slash);
+            zone->city = zone->name.mid(slash+1);
         }
     }
 }
 
-void TimeZoneInfoPrivate::parseZoneInfo(TimeZoneInfo *tzInfo)
+void TimeZoneInfoPrivate::parseZoneInfo(TimeZoneIndex::Zone *zone)
 {
-    if (!tzInfo) {
+    if (!zone) {
         return;
     }
 
-    QFile file(ZoneInfoPath + tzInfo->d->name);
+    QFile file(ZoneInfoPath + zone->name);
     if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Cannot open timezone file:" << file.fileName();
-        tzInfo->d->valid = false;
+        zone->valid = false;
         return;
     }
 
-    QByteArray data = file.readAll();
-    if (data.count() < 46 || !data.startsWith("TZif")) {
+    const qint64 size = file.size();
+    const uchar *data = size >= 44 ? file.map(0, size) : nullptr;
+    if (!data || !parseZoneInfoData(data, size, zone)) {
         qWarning() << "Invalid timezone file:" << file.fileName();
-        tzInfo->d->valid = false;
-        return;
+        zone->valid = false;
+    }
+}
+
+bool TimeZoneInfoPrivate::parseZoneInfoData(const uchar *data, qint64 size, TimeZoneIndex::Zone *zone)
+{
+    const uchar *end = data + size;
+    if (size < 44 || memcmp(data, "TZif", 4) != 0) {
+        return false;
     }
 
-    QDataStream ds(data);
-    ds.skipRawData(20); // 'TZif' plus version char plus 15 unused chars
+    // Version 2 and later files repeat the data with 64-bit transition times
+    // after the 32-bit block, followed by a POSIX TZ string for later times.
+    const uchar *blockEnd = nullptr;
+    if (data[4] >= '2') {
+        if (!parseZoneInfoBlock(data, end, 4, nullptr, &blockEnd)
+                || !parseZoneInfoBlock(blockEnd, end, 8, zone, &blockEnd)) {
+            return false;
+        }
+        if (blockEnd < end && *blockEnd == '\n') {
+            const uchar *ruleEnd = static_cast<const uchar *>(memchr(blockEnd + 1, '\n', end - blockEnd - 1));
+            if (ruleEnd) {
+                zone->rule = QByteArray(reinterpret_cast<const char *>(blockEnd + 1), ruleEnd - blockEnd - 1);
+            }
+        }
+        return true;
+    }
 
-    // read header
-    qint32 tzh_ttisgmtcnt, tzh_ttisstdcnt, tzh_leapcnt, tzh_timecnt, tzh_typecnt, tzh_charcnt;
-    ds >> tzh_ttisgmtcnt >> tzh_ttisstdcnt >> tzh_leapcnt >> tzh_timecnt >> tzh_typecnt >> tzh_charcnt;
+    return parseZoneInfoBlock(data, end, 4, zone, &blockEnd);
+}
 
-    // followed by tzh_timecnt four-byte values of type long
-    qint32 tmp32;
-    for (int i = 0; i < tzh_timecnt; ++i)
-        ds >> tmp32;
+// Reads one header and data block with transition times of timeSize bytes.
+// With a null zone the block is only validated and skipped.
+bool TimeZoneInfoPrivate::parseZoneInfoBlock(const uchar *data, const uchar *end, int timeSize,
+                                             TimeZoneIndex::Zone *zone, const uchar **blockEnd)
+{
+    if (end - data < 44 || memcmp(data, "TZif", 4) != 0) {
+        return false;
+    }
 
-    uchar tmp8 = 0;
-    QVarLengthArray<int, 128> transitionIndexes(tzh_timecnt);
-    // Next come  tzh_timecnt  one-byte  values of type unsigned  char
-    for (int i = 0; i < tzh_timecnt; ++i) {
-        ds >> tmp8;
-        transitionIndexes[i] = tmp8;
+    // 'TZif' plus version char plus 15 unused chars, then the header counts:
+    // tzh_ttisgmtcnt, tzh_ttisstdcnt, tzh_leapcnt, tzh_timecnt, tzh_typecnt, tzh_charcnt
+    const qint32 tzh_ttisgmtcnt = qFromBigEndian<qint32>(data + 20);
+    const qint32 tzh_ttisstdcnt = qFromBigEndian<qint32>(data + 24);
+    const qint32 tzh_leapcnt = qFromBigEndian<qint32>(data + 28);
+    const qint32 tzh_timecnt = qFromBigEndian<qint32>(data + 32);
+    const qint32 tzh_typecnt = qFromBigEndian<qint32>(data + 36);
+    const qint32 tzh_charcnt = qFromBigEndian<qint32>(data + 40);
+
+    if (tzh_ttisgmtcnt < 0 || tzh_ttisstdcnt < 0 || tzh_leapcnt < 0
+            || tzh_timecnt < 0 || tzh_typecnt <= 0 || tzh_charcnt < 0) {
+        return false;
+    }
+
+    const qint64 size = 44 + qint64(tzh_timecnt) * (timeSize + 1) + qint64(tzh_typecnt) * 6 + tzh_charcnt
+            + qint64(tzh_leapcnt) * (timeSize + 4) + tzh_ttisstdcnt + tzh_ttisgmtcnt;
+    if (size > end - data) {
+        return false;
     }
+    *blockEnd = data + size;
 
-    // then we have tzh_typecnt ttinfo structures
-    QVector<QPair<qint32,int> > types(tzh_typecnt);
+    if (!zone) {
+        return true;
+    }
+
+    // tzh_timecnt transition times, then tzh_timecnt one-byte type indexes,
+    // then tzh_typecnt six-byte ttinfo structures of tt_gmtoff (4),
+    // tt_isdst (1) and tt_abbrind (1).
+    const uchar *transitionTimes = data + 44;
+    const uchar *transitionIndexes = transitionTimes + tzh_timecnt * timeSize;
+    const uchar *types = transitionIndexes + tzh_timecnt;
+
+    QVarLengthArray<TimeZoneIndex::LocalTime, 16> localTimes(tzh_typecnt);
     for (int i = 0; i < tzh_typecnt; ++i) {
-        ds >> tmp32; // tt_gmtoff
-        ds >> tmp8;  // tt_isdst
-        types[i].first = tmp32;
-        types[i].second = tmp8;
-        ds >> tmp8;  // tt_abbrind
+        localTimes[i].offset = qFromBigEndian<qint32>(types + i * 6);
+        localTimes[i].isDst = types[i * 6 + 4] ? 1 : 0;
     }
 
-    if (tzh_typecnt)
-        tzInfo->d->offset = types[0].first;
+    // Local time type 0 applies before the first transition.
+    zone->initial = localTimes[0];
+    zone->offset = localTimes[0].offset;
 
-    if (tzh_timecnt) {
-        // find the last non-dst transition
-        int i = tzh_timecnt - 1;
-        while (i >= 0 && types[transitionIndexes[i]].second) {
-            --i;
+    // Transitions that only change the abbreviation are dropped.
+    zone->transitions.clear();
+    zone->transitions.reserve(tzh_timecnt);
+    TimeZoneIndex::LocalTime previous = zone->initial;
+    for (int i = 0; i < tzh_timecnt; ++i) {
+        const int type = transitionIndexes[i];
+        if (type >= tzh_typecnt) {
+            return false;
         }
-        if (i >= 0)
-            tzInfo->d->offset = types[transitionIndexes[i]].first;
+
+        const TimeZoneIndex::LocalTime &localTime = localTimes[type];
+        if (!localTime.isDst) {
+            zone->offset = localTime.offset;
+        }
+        if (localTime.offset == previous.offset && localTime.isDst == previous.isDst) {
+            continue;
+        }
+
+        TimeZoneIndex::Transition transition;
+        transition.time = timeSize == 8
+                ? qFromBigEndian<qint64>(transitionTimes + i * 8)
+                : qint64(qFromBigEndian<qint32>(transitionTimes + i * 4));
+        transition.localTime = localTime;
+        zone->transitions.append(transition);
+        previous = localTime;
     }
 
-    // ignore the rest for now
+    return true;
+}
+
+Q_STATIC_ASSERT(sizeof(TimeZoneInfo) == sizeof(void *));
+
+namespace {
+
+const TimeZoneIndex::Record &recordOf(const TimeZoneHandle *handle)
+{
+    return handle->index->record(handle->record);
+}
+
+const char *stringOf(const TimeZoneHandle *handle, quint32 TimeZoneIndex::Record::*field)
+{
+    return handle->index->string(recordOf(handle).*field);
+}
+
+qint64 secondsSinceEpoch(const QDateTime &dateTime)
+{
+    const qint64 msecs = dateTime.toMSecsSinceEpoch();
+    return msecs >= 0 ? msecs / 1000 : (msecs - 999) / 1000;
 }
 
+}
 
 TimeZoneInfo::TimeZoneInfo()
-    : d(new TimeZoneInfoPrivate)
+    : d(nullptr)
 {
 }
 
+TimeZoneInfo::TimeZoneInfo(TimeZoneIndex *index, int record)
+    : d(index->handle(record))
+{
+    d->index->ref.ref();
+}
+
 TimeZoneInfo::~TimeZoneInfo()
 {
-    delete d;
+    if (d && !d->index->ref.deref()) {
+        delete d->index;
+    }
 }
 
 TimeZoneInfo::TimeZoneInfo(const TimeZoneInfo &other)
-    : d(new TimeZoneInfoPrivate)
+    : d(other.d)
 {
-    operator=(other);
+    if (d) {
+        d->index->ref.ref();
+    }
 }
 
 bool TimeZoneInfo::isValid() const
 {
-    return d->valid;
+    return d != nullptr;
 }
 
 QByteArray TimeZoneInfo::countryCode() const
 {
-    return d->countryCode;
+    return d ? QByteArray(stringOf(d, &TimeZoneIndex::Record::countryCode)) : QByteArray();
 }
 
 QByteArray TimeZoneInfo::countryName() const
 {
-    return d->countryName;
+    return d ? QByteArray(stringOf(d, &TimeZoneIndex::Record::countryName)) : QByteArray();
 }
 
 QByteArray TimeZoneInfo::name() const
 {
-    return d->name;
+    return d ? QByteArray(stringOf(d, &TimeZoneIndex::Record::name)) : QByteArray();
 }
 
 QByteArray TimeZoneInfo::area() const
 {
-    return d->area;
+    return d ? QByteArray(stringOf(d, &TimeZoneIndex::Record::area)) : QByteArray();
 }
 
 QByteArray TimeZoneInfo::city() const
 {
-    return d->city;
+    return d ? QByteArray(stringOf(d, &TimeZoneIndex::Record::city)) : QByteArray();
 }
 
 QByteArray TimeZoneInfo::comments() const
 {
-    return d->comments;
+    return d ? QByteArray(stringOf(d, &TimeZoneIndex::Record::comments)) : QByteArray();
 }
 
 qint32 TimeZoneInfo::offset() const
 {
-    return d->offset;
+    return d ? recordOf(d).offset : 0;
+}
+
+qint32 TimeZoneInfo::offsetAt(const QDateTime &dateTime) const
+{
+    return d ? d->index->localTimeAt(d->record, secondsSinceEpoch(dateTime)).offset : 0;
+}
+
+bool TimeZoneInfo::isDstAt(const QDateTime &dateTime) const
+{
+    return d ? d->index->localTimeAt(d->record, secondsSinceEpoch(dateTime)).isDst : false;
 }
 
 TimeZoneInfo &TimeZoneInfo::operator=(const TimeZoneInfo &other)
 {
-    if (this == &other) {
-        return *this;
+    if (other.d) {
+        other.d->index->ref.ref();
     }
-
-    d->name = other.d->name;
-    d->area = other.d->area;
-    d->city = other.d->city;
-    d->countryCode = other.d->countryCode;
-    d->countryName = other.d->countryName;
-    d->comments = other.d->comments;
-    d->offset = other.d->offset;
-    d->valid = other.d->valid;
+    if (d && !d->index->ref.deref()) {
+        delete d->index;
+    }
+    d = other.d;
 
     return *this;
 }
 
 bool TimeZoneInfo::operator==(const TimeZoneInfo &other) const
 {
-    return d->name == other.d->name;
+    if (d == other.d) {
+        return true;
+    } else if (!d || !other.d) {
+        return false;
+    }
+    return strcmp(stringOf(d, &TimeZoneIndex::Record::name), stringOf(other.d, &TimeZoneIndex::Record::name)) == 0;
 }
 
 bool TimeZoneInfo::operator!=(const TimeZoneInfo &other) const
 {
-    return d->name != other.d->name;
+    return !operator==(other);
 }
 
 QList<TimeZoneInfo> TimeZoneInfo::systemTimeZones()
 {
-    return TimeZoneInfoPrivate::parseZoneTab();
+    return TimeZoneInfoPrivate::systemTimeZones();
 }
@@ -37,7 +37,10 @@
 
 #include <systemsettingsglobal.h>
 
+class QDateTime;
+class TimeZoneIndex;
 class TimeZoneInfoPrivate;
+struct TimeZoneHandle;
 
 class SYSTEMSETTINGS_EXPORT TimeZoneInfo
 {
@@ -56,6 +59,11 @@ public:
     QByteArray comments() const;
     qint32 offset() const;
 
+    // UTC offset in seconds and daylight saving state at the given time,
+    // following the zone's transitions and its rule for later dates.
+    qint32 offsetAt(const QDateTime &dateTime) const;
+    bool isDstAt(const QDateTime &dateTime) const;
+
     TimeZoneInfo &operator=(const TimeZoneInfo &other);
     bool operator==(const TimeZoneInfo &other) const;
     bool operator!=(const TimeZoneInfo &other) const;
@@ -64,6 +72,13 @@ public:
 
 private:
     friend class TimeZoneInfoPrivate;
-    TimeZoneInfoPrivate *d;
+    TimeZoneInfo(TimeZoneIndex *index, int record);
+
+    // One record of the shared zone table, copies only take a reference on
+    // the table. Pointer sized so QList stores zones inline.
+    const TimeZoneHandle *d;
 };
+
+Q_DECLARE_TYPEINFO(TimeZoneInfo, Q_MOVABLE_TYPE);
+
 #endif
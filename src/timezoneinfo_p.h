@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef TIMEZONEINFO_P_H
+#define TIMEZONEINFO_P_H
+
+#include "timezoneinfo.h"
+#include "timezoneindex_p.h"
+
+class TimeZoneInfoPrivate
+{
+public:
+    static QList<TimeZoneInfo> systemTimeZones();
+    static QVector<TimeZoneIndex::Zone> parseZoneTab();
+    static void parseZoneTabLine(const QByteArray &line, TimeZoneIndex::Zone *zone);
+    static void parseZoneInfo(TimeZoneIndex::Zone *zone);
+    static bool parseZoneInfoData(const uchar *data, qint64 size, TimeZoneIndex::Zone *zone);
+    static bool parseZoneInfoBlock(const uchar *data, const uchar *end, int timeSize,
+                                   TimeZoneIndex::Zone *zone, const uchar **blockEnd);
+
+    static TimeZoneInfo timeZoneInfo(TimeZoneIndex *index, int record) { return TimeZoneInfo(index, record); }
+};
+
+#endif
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "timezonemodel.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+
+namespace {
+
+// Case folds and strips diacritics, also transliterating the Latin letters
+// that have no decomposition.
+QString fold(const QString &text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString folded;
+    folded.reserve(decomposed.size());
+    for (const QChar ch : decomposed) {
+        if (ch.isMark()) {
+            continue;
+        }
+
+        const QChar lower = ch.toCaseFolded();
+        switch (lower.unicode()) {
+        case 0x00df: folded += QLatin1String("ss"); break;     // ß
+        case 0x00e6: folded += QLatin1String("ae"); break;     // æ
+        case 0x0153: folded += QLatin1String("oe"); break;     // œ
+        case 0x00fe: folded += QLatin1String("th"); break;     // þ
+        case 0x00f8: folded += QLatin1Char('o'); break;        // ø
+        case 0x00f0:                                           // ð
+        case 0x0111: folded += QLatin1Char('d'); break;        // đ
+        case 0x0142: folded += QLatin1Char('l'); break;        // ł
+        case 0x0131: folded += QLatin1Char('i'); break;        // ı
+        default: folded += lower; break;
+        }
+    }
+    return folded;
+}
+
+QStringList words(const QString &text)
+{
+    QStringList words;
+    const QString folded = fold(text);
+    int start = -1;
+    for (int i = 0; i <= folded.size(); ++i) {
+        const bool wordCharacter = i < folded.size() && folded.at(i).isLetterOrNumber();
+        if (wordCharacter && start < 0) {
+            start = i;
+        } else if (!wordCharacter && start >= 0) {
+            words.append(folded.mid(start, i - start));
+            start = -1;
+        }
+    }
+    return words;
+}
+
+}
+
+TimeZoneModel::TimeZoneModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_timeZones(TimeZoneInfo::systemTimeZones())
+{
+    std::sort(m_timeZones.begin(), m_timeZones.end(), [](const TimeZoneInfo &left, const TimeZoneInfo &right) {
+        return left.name() < right.name();
+    });
+
+    for (int i = 0; i < m_timeZones.count(); ++i) {
+        const TimeZoneInfo &timeZone = m_timeZones.at(i);
+        const QString fields[] = {
+            QString::fromUtf8(timeZone.city()),
+            QString::fromUtf8(timeZone.area()),
+            QString::fromUtf8(timeZone.countryName()),
+            QString::fromUtf8(timeZone.countryCode())
+        };
+        QStringList zoneWords;
+        for (const QString &field : fields) {
+            zoneWords += words(field);
+        }
+        zoneWords.removeDuplicates();
+        for (const QString &word : zoneWords) {
+            m_words.append(qMakePair(word, i));
+        }
+    }
+    std::sort(m_words.begin(), m_words.end());
+
+    m_rows.reserve(m_timeZones.count());
+    for (int i = 0; i < m_timeZones.count(); ++i) {
+        m_rows.append(i);
+    }
+}
+
+TimeZoneModel::~TimeZoneModel()
+{
+}
+
+QString TimeZoneModel::filter() const
+{
+    return m_filter;
+}
+
+void TimeZoneModel::setFilter(const QString &filter)
+{
+    if (m_filter == filter) {
+        return;
+    }
+    m_filter = filter;
+
+    // Both row lists are ascending subsequences of the zones, so a merge
+    // walk gives the removed and inserted ranges.
+    const QVector<int> previous = m_rows;
+    const QVector<int> current = match(filter);
+
+    int row = 0;
+    int i = 0;
+    int j = 0;
+    while (i < previous.count() || j < current.count()) {
+        if (j == current.count() || (i < previous.count() && previous.at(i) < current.at(j))) {
+            int count = 1;
+            while (i + count < previous.count() && (j == current.count() || previous.at(i + count) < current.at(j))) {
+                ++count;
+            }
+            beginRemoveRows(QModelIndex(), row, row + count - 1);
+            m_rows.remove(row, count);
+            endRemoveRows();
+            i += count;
+        } else if (i == previous.count() || current.at(j) < previous.at(i)) {
+            int count = 1;
+            while (j + count < current.count() && (i == previous.count() || current.at(j + count) < previous.at(i))) {
+                ++count;
+            }
+            beginInsertRows(QModelIndex(), row, row + count - 1);
+            for (int k = 0; k < count; ++k) {
+                m_rows.insert(row + k, current.at(j + k));
+            }
+            endInsertRows();
+            row += count;
+            j += count;
+        } else {
+            ++row;
+            ++i;
+            ++j;
+        }
+    }
+
+    emit filterChanged();
+    if (previous.count() != m_rows.count()) {
+        emit countChanged();
+    }
+}
+
+QVector<int> TimeZoneModel::match(const QString &filter) const
+{
+    const QStringList filterWords = words(filter);
+
+    QVector<int> rows;
+    if (filterWords.isEmpty()) {
+        rows.reserve(m_timeZones.count());
+        for (int i = 0; i < m_timeZones.count(); ++i) {
+            rows.append(i);
+        }
+        return rows;
+    }
+
+    // Count per zone how many of the filter words prefix one of its words.
+    QVector<int> matched(m_timeZones.count(), 0);
+    QVector<int> lastWord(m_timeZones.count(), -1);
+    for (int w = 0; w < filterWords.count(); ++w) {
+        const QString &prefix = filterWords.at(w);
+        auto it = std::lower_bound(m_words.constBegin(), m_words.constEnd(), qMakePair(prefix, -1));
+        for (; it != m_words.constEnd() && it->first.startsWith(prefix); ++it) {
+            if (lastWord.at(it->second) != w) {
+                lastWord[it->second] = w;
+                ++matched[it->second];
+            }
+        }
+    }
+
+    for (int i = 0; i < matched.count(); ++i) {
+        if (matched.at(i) == filterWords.count()) {
+            rows.append(i);
+        }
+    }
+    return rows;
+}
+
+int TimeZoneModel::indexOf(const QString &name) const
+{
+    const QByteArray zoneName = name.toUtf8();
+    for (int row = 0; row < m_rows.count(); ++row) {
+        if (m_timeZones.at(m_rows.at(row)).name() == zoneName) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+QHash<int, QByteArray> TimeZoneModel::roleNames() const
+{
+    static const QHash<int, QByteArray> roles = {
+        { NameRole, "name" },
+        { AreaRole, "area" },
+        { CityRole, "city" },
+        { CountryCodeRole, "countryCode" },
+        { CountryNameRole, "countryName" },
+        { CommentsRole, "comments" },
+        { OffsetRole, "offset" },
+        { DaylightSavingRole, "daylightSaving" }
+    };
+
+    return roles;
+}
+
+int TimeZoneModel::rowCount(const QModelIndex &parent) const
+{
+    return !parent.isValid() ? m_rows.count() : 0;
+}
+
+QVariant TimeZoneModel::data(const QModelIndex &index, int role) const
+{
+    const int row = index.row();
+    if (row < 0 || row >= m_rows.count() || index.column() != 0) {
+        return QVariant();
+    }
+
+    const TimeZoneInfo &timeZone = m_timeZones.at(m_rows.at(row));
+    switch (role) {
+    case NameRole:
+        return QString::fromUtf8(timeZone.name());
+    case AreaRole:
+        return QString::fromUtf8(timeZone.area());
+    case CityRole:
+        return QString::fromUtf8(timeZone.city());
+    case CountryCodeRole:
+        return QString::fromUtf8(timeZone.countryCode());
+    case CountryNameRole:
+        return QString::fromUtf8(timeZone.countryName());
+    case CommentsRole:
+        return QString::fromUtf8(timeZone.comments());
+    case OffsetRole:
+        return timeZone.offsetAt(QDateTime::currentDateTimeUtc());
+    case DaylightSavingRole:
+        return timeZone.isDstAt(QDateTime::currentDateTimeUtc());
+    default:
+        return QVariant();
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef TIMEZONEMODEL_H
+#define TIMEZONEMODEL_H
+
+#include <QAbstractListModel>
+#include <QPair>
+#include <QVector>
+
+#include <timezoneinfo.h>
+
+class SYSTEMSETTINGS_EXPORT TimeZoneModel : public QAbstractListModel
+{
+    Q_OBJECT
+    // Space separated words, each has to prefix a word of the city, area,
+    // country name or country code. Case and diacritics are ignored.
+    Q_PROPERTY(QString filter READ filter WRITE setFilter NOTIFY filterChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum TimeZoneRoles {
+        NameRole = Qt::UserRole + 1,
+        AreaRole,
+        CityRole,
+        CountryCodeRole,
+        CountryNameRole,
+        CommentsRole,
+        OffsetRole,
+        DaylightSavingRole
+    };
+
+    explicit TimeZoneModel(QObject *parent = nullptr);
+    ~TimeZoneModel();
+
+    QString filter() const;
+    void setFilter(const QString &filter);
+
+    Q_INVOKABLE int indexOf(const QString &name) const;
+
+    QHash<int, QByteArray> roleNames() const override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+signals:
+    void filterChanged();
+    void countChanged();
+
+private:
+    QVector<int> match(const QString &filter) const;
+
+    QList<TimeZoneInfo> m_timeZones;
+    QVector<QPair<QString, int>> m_words;    // sorted folded words and the zone they belong to
+    QVector<int> m_rows;                     // zones passing the filter, ascending
+    QString m_filter;
+};
+
+#endif
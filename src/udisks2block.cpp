@@ -1,32 +1,27 @@
 #include "udisks2block_p.h"
 #include "udisks2defines.h"
+#include "dbuscallstatistics_p.h"
 #include "logging_p.h"
 
 #include <nemo-dbus/dbus.h>
 #include <nemo-dbus/interface.h>
 
-UDisks2::Block::Block(const QString &path, const UDisks2::InterfacePropertyMap &interfacePropertyMap, QObject *parent)
+#include <QElapsedTimer>
+
+UDisks2::Block::Block(const QString &path, const UDisks2::InterfacePropertyMap &interfacePropertyMap,
+                      const QVariantMap &driveProperties, QObject *parent)
     : QObject(parent)
     , m_path(path)
     , m_interfacePropertyMap(interfacePropertyMap)
     , m_data(interfacePropertyMap.value(UDISKS2_BLOCK_INTERFACE))
+    , m_drive(driveProperties)
     , m_connection(QDBusConnection::systemBus(), lcMemoryCardDBusLog())
     , m_mountable(interfacePropertyMap.contains(UDISKS2_FILESYSTEM_INTERFACE))
     , m_encrypted(interfacePropertyMap.contains(UDISKS2_ENCRYPTED_INTERFACE))
     , m_formatting(false)
     , m_locking(false)
 {
-    if (!m_connection.connectToSignal(
-                UDISKS2_SERVICE,
-                m_path,
-                DBUS_OBJECT_PROPERTIES_INTERFACE,
-                UDisks2::propertiesChangedSignal,
-                this,
-                SLOT(updateProperties(QDBusMessage)))) {
-        qCWarning(lcMemoryCardLog) << "Failed to connect to Block properties change interface" << m_path
-                                   << m_connection.connection().lastError().message();
-    }
-
+    // Property changes are dispatched by UDisks2::Monitor, see Monitor::propertiesChanged().
     qCInfo(lcMemoryCardLog) << "Creating a new block. Mountable:" << m_mountable << ", encrypted:" << m_encrypted
                             << "object path:" << m_path << "data is empty:" << m_data.isEmpty();
 
@@ -82,12 +77,16 @@ UDisks2::Block::Block(const QString &path, const UDisks2::InterfacePropertyMap &
             updateFileSystemInterface(map);
         }
 
-        getProperties(
-                drive(), UDISKS2_DRIVE_INTERFACE, &m_pendingDrive,
-                [this](const QVariantMap &driveProperties) {
-                    qCInfo(lcMemoryCardLog) << "Drive properties:" << driveProperties;
-                    m_drive = driveProperties;
-                });
+        // Drive properties are normally known already (e.g. from GetManagedObjects).
+        // Query them only if the drive appeared after the snapshot was taken.
+        if (m_drive.isEmpty()) {
+            getProperties(
+                    drive(), UDISKS2_DRIVE_INTERFACE, &m_pendingDrive,
+                    [this](const QVariantMap &driveProperties) {
+                        qCInfo(lcMemoryCardLog) << "Drive properties:" << driveProperties;
+                        m_drive = driveProperties;
+                    });
+        }
 
         complete();
     }
@@ -372,6 +371,12 @@ QString UDisks2::Block::cryptoBackingDevicePath(const QString &objectPath)
     }
 }
 
+QString UDisks2::Block::drivePath(const UDisks2::InterfacePropertyMap &interfacePropertyMap)
+{
+    const QVariant drive = interfacePropertyMap.value(UDISKS2_BLOCK_INTERFACE).value(QStringLiteral("Drive"));
+    return NemoDBus::demarshallDBusArgument(drive).toString();
+}
+
 void UDisks2::Block::addInterface(const QString &interface, QVariantMap propertyMap)
 {
     m_interfacePropertyMap.insert(interface, propertyMap);
@@ -504,12 +509,19 @@ void UDisks2::Block::getProperties(const QString &path, const QString &interface
 
     *pending = true;
 
+    // GetAll is broken down by the interface it reads.
+    const QString method = QStringLiteral("%1(%2)").arg(DBUS_GET_ALL, interface);
+    QElapsedTimer callTimer;
+    callTimer.start();
+
     NemoDBus::Interface dbusPropertyInterface(this, m_connection, UDISKS2_SERVICE, path, DBUS_OBJECT_PROPERTIES_INTERFACE);
     NemoDBus::Response *response = dbusPropertyInterface.call(DBUS_GET_ALL, interface);
-    response->onFinished<QVariantMap>([this, success](const QVariantMap &values) {
+    response->onFinished<QVariantMap>([this, success, method, callTimer](const QVariantMap &values) {
+        DBusCallStatistics::instance()->record(DBUS_OBJECT_PROPERTIES_INTERFACE, method, callTimer.nsecsElapsed(), true);
         success(NemoDBus::demarshallArgument<QVariantMap>(values));
     });
-    response->onError([this, failed, path, interface](const QDBusError &error) {
+    response->onError([this, failed, path, interface, method, callTimer](const QDBusError &error) {
+        DBusCallStatistics::instance()->record(DBUS_OBJECT_PROPERTIES_INTERFACE, method, callTimer.nsecsElapsed(), false);
         qCDebug(lcMemoryCardLog) << "Get properties failed" << path << "interface:" << interface;
         qCDebug(lcMemoryCardLog) << "Error reading" << interface << "properties:" << error.name() << error.message();
         failed();
@@ -55,7 +55,8 @@ class SYSTEMSETTINGS_EXPORT Block : public QObject
     Q_PROPERTY(QString connectionBus READ connectionBus NOTIFY updated)
 
 public:
-    Block(const QString &path, const UDisks2::InterfacePropertyMap &interfacePropertyMap, QObject *parent = nullptr);
+    Block(const QString &path, const UDisks2::InterfacePropertyMap &interfacePropertyMap,
+          const QVariantMap &driveProperties = QVariantMap(), QObject *parent = nullptr);
     virtual ~Block();
 
     QString path() const;
@@ -112,6 +113,7 @@ public:
     void dumpInfo() const;
 
     static QString cryptoBackingDevicePath(const QString &objectPath);
+    static QString drivePath(const UDisks2::InterfacePropertyMap &interfacePropertyMap);
 
 signals:
     void completed(QPrivateSignal);
@@ -168,6 +170,7 @@ private:
     bool m_pendingPartitionTable = false;
 
     friend class BlockDevices;
+    friend class Monitor;
 };
 
 }
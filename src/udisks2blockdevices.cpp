@@ -38,6 +38,8 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 #define PARTITION_WAIT_TIMEOUT 3000
 
 using namespace UDisks2;
@@ -61,14 +63,14 @@ BlockDevices::~BlockDevices()
 
 bool BlockDevices::contains(const QString &dbusObjectPath) const
 {
-    return m_activeBlockDevices.contains(dbusObjectPath);
+    return m_states.value(dbusObjectPath) & Active;
 }
 
 void BlockDevices::remove(const QString &dbusObjectPath)
 {
     if (contains(dbusObjectPath)) {
-        Block *block = m_blockDevices.take(dbusObjectPath);
-        m_activeBlockDevices.remove(dbusObjectPath);
+        Block *block = clearState(dbusObjectPath, Existing);
+        clearState(dbusObjectPath, Active);
         clearPartitionWait(dbusObjectPath, false);
         delete block;
     }
@@ -85,12 +87,13 @@ Block *BlockDevices::device(const QString &dbusObjectPath) const
 
 void BlockDevices::deactivate(const QString &dbusObjectPath)
 {
-    m_activeBlockDevices.remove(dbusObjectPath);
+    clearState(dbusObjectPath, Active);
 }
 
 void BlockDevices::insert(const QString &dbusObjectPath, Block *block)
 {
-    m_activeBlockDevices.insert(dbusObjectPath, block);
+    Q_ASSERT(dbusObjectPath == block->path());
+    setState(block, Active);
 }
 
 Block *BlockDevices::find(std::function<bool (const Block *)> condition)
@@ -121,29 +124,15 @@ Block *BlockDevices::find(std::function<bool (const Block *)> condition)
 
 Block *BlockDevices::find(const QString &devicePath)
 {
-    return find([devicePath](const Block *block){
-        return block->device() == devicePath || block->cryptoBackingDevicePath() == devicePath;
-    });
+    return preferred(m_devicePathIndex.values(devicePath) + m_cryptoBackingDevicePathIndex.values(devicePath));
 }
 
 QString BlockDevices::objectPath(const QString &devicePath) const
 {
-    for (QMap<QString, Block *>::const_iterator i = m_activeBlockDevices.constBegin(); i != m_activeBlockDevices.constEnd(); ++i) {
-        Block *block = i.value();
-        if (block->device() == devicePath) {
-            return block->path();
-        } else if (block->cryptoBackingDevicePath() == devicePath) {
-            return block->cryptoBackingDeviceObjectPath();
-        }
-    }
-
-    for (QMap<QString, Block *>::const_iterator i = m_blockDevices.constBegin(); i != m_blockDevices.constEnd(); ++i) {
-        Block *block = i.value();
-        if (block->device() == devicePath) {
-            return block->path();
-        } else if (block->cryptoBackingDevicePath() == devicePath) {
-            return block->cryptoBackingDeviceObjectPath();
-        }
+    if (Block *block = preferred(m_devicePathIndex.values(devicePath), States(Existing | Active))) {
+        return block->path();
+    } else if (Block *block = preferred(m_cryptoBackingDevicePathIndex.values(devicePath), States(Existing | Active))) {
+        return block->cryptoBackingDeviceObjectPath();
     }
 
     return QString();
@@ -153,16 +142,12 @@ QStringList BlockDevices::devicePaths(const QStringList &dbusObjectPaths) const
 {
     QStringList paths;
     for (const QString &objectPath : dbusObjectPaths) {
-        for (QMap<QString, Block *>::const_iterator i = m_activeBlockDevices.constBegin(); i != m_activeBlockDevices.constEnd(); ++i) {
-            Block *block = i.value();
-            if (block->path() == objectPath || block->cryptoBackingDeviceObjectPath() == objectPath) {
-                paths << block->device();
-            }
+        if (Block *block = device(objectPath)) {
+            paths << block->device();
         }
 
-        for (QMap<QString, Block *>::const_iterator i = m_blockDevices.constBegin(); i != m_blockDevices.constEnd(); ++i) {
-            Block *block = i.value();
-            if (block->path() == objectPath || block->cryptoBackingDeviceObjectPath() == objectPath) {
+        for (const Block *block : m_cryptoBackingObjectPathIndex.values(objectPath)) {
+            if (m_states.value(block->path()) & (Existing | Active)) {
                 paths << block->device();
             }
         }
@@ -175,16 +160,44 @@ bool BlockDevices::createBlockDevice(const QString &dbusObjectPath, const Interf
     return doCreateBlockDevice(dbusObjectPath, interfacePropertyMap);
 }
 
-void BlockDevices::createBlockDevices(const QList<QDBusObjectPath> &devices)
+void BlockDevices::createBlockDevices(const ObjectInterfacePropertyMap &objects)
 {
-    m_blockCount = devices.count();
+    // Drives first so that blocks can be created without querying their drive properties.
+    QStringList blockDevicePaths;
+    for (ObjectInterfacePropertyMap::const_iterator i = objects.constBegin(); i != objects.constEnd(); ++i) {
+        const QString path = i.key().path();
+        if (path.startsWith(UDISKS2_DRIVES_PATH_PREFIX) && i.value().contains(UDISKS2_DRIVE_INTERFACE)) {
+            addDrive(path, i.value().value(UDISKS2_DRIVE_INTERFACE));
+        } else if (path.startsWith(UDISKS2_BLOCK_DEVICES_PATH_PREFIX)) {
+            blockDevicePaths << path;
+        }
+    }
+
+    m_blockCount = blockDevicePaths.count();
     updatePopulatedCheck();
 
-    for (const QDBusObjectPath &dbusObjectPath : devices) {
-        createBlockDevice(dbusObjectPath.path(), UDisks2::InterfacePropertyMap());
+    for (const QString &dbusObjectPath : blockDevicePaths) {
+        const InterfacePropertyMap interfacePropertyMap = objects.value(QDBusObjectPath(dbusObjectPath));
+        // Object was caught in the middle of being exported, fall back to reading
+        // the properties of each interface separately.
+        if (!interfacePropertyMap.contains(UDISKS2_BLOCK_INTERFACE)) {
+            createBlockDevice(dbusObjectPath, UDisks2::InterfacePropertyMap());
+        } else {
+            createBlockDevice(dbusObjectPath, interfacePropertyMap);
+        }
     }
 }
 
+void BlockDevices::addDrive(const QString &dbusObjectPath, const QVariantMap &driveProperties)
+{
+    m_drives.insert(dbusObjectPath, driveProperties);
+}
+
+void BlockDevices::removeDrive(const QString &dbusObjectPath)
+{
+    m_drives.remove(dbusObjectPath);
+}
+
 void BlockDevices::lock(const QString &dbusObjectPath)
 {
     Block *newActive = m_blockDevices.value(dbusObjectPath, nullptr);
@@ -225,8 +238,8 @@ void BlockDevices::removeInterfaces(const QString &dbusObjectPath, const QString
 
         if (interfaces.contains(UDISKS2_BLOCK_INTERFACE)) {
             delete block;
-            m_activeBlockDevices.remove(dbusObjectPath);
-            m_blockDevices.remove(dbusObjectPath);
+            clearState(dbusObjectPath, Active);
+            clearState(dbusObjectPath, Existing);
         } else {
             if (interfaces.contains(UDISKS2_FILESYSTEM_INTERFACE)) {
                 block->removeInterface(UDISKS2_FILESYSTEM_INTERFACE);
@@ -255,9 +268,15 @@ bool BlockDevices::hintAuto(const Block *maybeHintAuto)
 
 bool BlockDevices::hintAuto(const QString &devicePath)
 {
-    Block *maybeHintAuto = find([devicePath](const Block *block) {
-        return block->device() == devicePath || block->path() == devicePath;
-    });
+    // Accepts both device paths and D-Bus object paths.
+    QList<Block *> candidates = m_devicePathIndex.values(devicePath);
+    for (State state : { Active, Existing, Pending }) {
+        if (Block *block = blocks(state).value(devicePath, nullptr)) {
+            candidates << block;
+        }
+    }
+
+    Block *maybeHintAuto = preferred(candidates);
     if (!maybeHintAuto)
         return false;
 
@@ -315,9 +334,19 @@ Block *BlockDevices::doCreateBlockDevice(const QString &dbusObjectPath, const In
         return block;
     }
 
-    Block *block = new Block(dbusObjectPath, interfacePropertyMap);
+    Block *block = new Block(dbusObjectPath, interfacePropertyMap, m_drives.value(Block::drivePath(interfacePropertyMap)));
     updateFormattingState(block);
     connect(block, &Block::completed, this, &BlockDevices::blockCompleted);
+    connect(block, &Block::updated, this, [this, block]() {
+        // Device and crypto backing device come from the block interface which can change.
+        if (m_indexEntries.contains(block)) {
+            updateIndex(block);
+        }
+    });
+    connect(block, &QObject::destroyed, this, [this, block]() {
+        removeIndex(block);
+    });
+    emit blockCreated(block);
     return block;
 }
 
@@ -361,7 +390,7 @@ void BlockDevices::complete(Block *block, bool forceAccept)
     // before exposing them outside.
     // Mark a block as pending if block devices is not yet populated.
     if (!populated()) {
-        m_pendingBlockDevices.insert(block->path(), block);
+        setState(block, Pending);
         return;
     }
 
@@ -373,10 +402,11 @@ void BlockDevices::complete(Block *block, bool forceAccept)
     // Check if device is already unlocked.
     Block *unlocked = nullptr;
     if (block->isEncrypted()) {
-        QString newPath = block->path();
-        unlocked = find([newPath](const Block *block) {
-            return block->cryptoBackingDeviceObjectPath() == newPath && !block->isLocking();
-        });
+        QList<Block *> candidates = m_cryptoBackingObjectPathIndex.values(block->path());
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](const Block *candidate) {
+            return candidate->isLocking();
+        }), candidates.end());
+        unlocked = preferred(candidates);
     }
 
     bool willAccept = !unlocked && (block->isPartition() || block->isMountable() || block->isEncrypted() || block->isFormatting() || forceAccept);
@@ -387,12 +417,12 @@ void BlockDevices::complete(Block *block, bool forceAccept)
     if (willAccept) {
         // Hope that somebody will handle this signal and call insert()
         // to add this block to m_activeBlockDevices.
-        m_blockDevices.insert(block->path(), block);
+        setState(block, Existing);
         emit newBlock(block, false);
     } else if (block->isPartition()) {
         // Silently keep partitions around so that we can filter out
         // partition tables in timerEvent().
-        m_blockDevices.insert(block->path(), block);
+        setState(block, Existing);
         insert(block->path(), block);
     } else {
         // This is garbage block device that should not be exposed
@@ -432,16 +462,118 @@ void BlockDevices::updatePopulatedCheck()
         if (m_blockCount <= 0) {
             m_populated = true;
 
-            for (Block *block : m_pendingBlockDevices) {
+            const QList<Block *> pendingBlocks = m_pendingBlockDevices.values();
+            for (Block *block : pendingBlocks) {
+                clearState(block->path(), Pending);
                 complete(block);
             }
-            m_pendingBlockDevices.clear();
             emit externalStoragesPopulated();
             m_blockCount = 0;
         }
     }
 }
 
+QMap<QString, Block *> &BlockDevices::blocks(State state)
+{
+    switch (state) {
+    case Pending:
+        return m_pendingBlockDevices;
+    case Existing:
+        return m_blockDevices;
+    case Active:
+    default:
+        return m_activeBlockDevices;
+    }
+}
+
+void BlockDevices::setState(Block *block, State state)
+{
+    const QString path = block->path();
+    blocks(state).insert(path, block);
+    m_states[path] |= state;
+    updateIndex(block);
+}
+
+Block *BlockDevices::clearState(const QString &dbusObjectPath, State state)
+{
+    Block *block = blocks(state).take(dbusObjectPath);
+
+    QHash<QString, States>::iterator it = m_states.find(dbusObjectPath);
+    if (it != m_states.end()) {
+        *it &= ~state;
+        if (!*it) {
+            m_states.erase(it);
+        }
+    }
+
+    // Keep indexing the block as long as it is in any of the maps.
+    if (block && !m_activeBlockDevices.contains(dbusObjectPath)
+            && !m_blockDevices.contains(dbusObjectPath)
+            && !m_pendingBlockDevices.contains(dbusObjectPath)) {
+        removeIndex(block);
+    }
+
+    return block;
+}
+
+Block *BlockDevices::preferred(const QList<Block *> &candidates, States states) const
+{
+    // Same precedence as the linear lookups had: active, existing, then pending
+    // and in object path order within each.
+    Block *best = nullptr;
+    int bestRank = 0;
+    for (Block *candidate : candidates) {
+        const States candidateStates = m_states.value(candidate->path()) & states;
+        if (!candidateStates) {
+            continue;
+        }
+
+        const int rank = candidateStates & Active ? 0 : candidateStates & Existing ? 1 : 2;
+        if (!best || rank < bestRank || (rank == bestRank && candidate->path() < best->path())) {
+            best = candidate;
+            bestRank = rank;
+        }
+    }
+    return best;
+}
+
+void BlockDevices::updateIndex(Block *block)
+{
+    removeIndex(block);
+
+    IndexEntry entry;
+    entry.devicePath = block->device();
+    entry.cryptoBackingDevicePath = block->cryptoBackingDevicePath();
+    if (block->hasCryptoBackingDevice()) {
+        entry.cryptoBackingObjectPath = block->cryptoBackingDeviceObjectPath();
+    }
+
+    if (!entry.devicePath.isEmpty()) {
+        m_devicePathIndex.insert(entry.devicePath, block);
+    }
+    if (!entry.cryptoBackingDevicePath.isEmpty()) {
+        m_cryptoBackingDevicePathIndex.insert(entry.cryptoBackingDevicePath, block);
+    }
+    if (!entry.cryptoBackingObjectPath.isEmpty()) {
+        m_cryptoBackingObjectPathIndex.insert(entry.cryptoBackingObjectPath, block);
+    }
+    m_indexEntries.insert(block, entry);
+}
+
+void BlockDevices::removeIndex(const Block *block)
+{
+    QHash<const Block *, IndexEntry>::iterator it = m_indexEntries.find(block);
+    if (it == m_indexEntries.end()) {
+        return;
+    }
+
+    Block *indexed = const_cast<Block *>(block);
+    m_devicePathIndex.remove(it->devicePath, indexed);
+    m_cryptoBackingDevicePathIndex.remove(it->cryptoBackingDevicePath, indexed);
+    m_cryptoBackingObjectPathIndex.remove(it->cryptoBackingObjectPath, indexed);
+    m_indexEntries.erase(it);
+}
+
 BlockDevices::PartitionWaiter::PartitionWaiter(int timer, Block *block)
     : timer(timer)
     , block(block)
@@ -32,6 +32,7 @@
 #ifndef UDISKS2_BLOCK_DEVICES_H
 #define UDISKS2_BLOCK_DEVICES_H
 
+#include <QHash>
 #include <QMap>
 #include <QPointer>
 #include <functional>
@@ -64,7 +65,10 @@ public:
     QStringList devicePaths(const QStringList &dbusObjectPaths) const;
 
     bool createBlockDevice(const QString &dbusObjectPath, const InterfacePropertyMap &interfacePropertyMap);
-    void createBlockDevices(const QList<QDBusObjectPath> &devices);
+    void createBlockDevices(const ObjectInterfacePropertyMap &objects);
+
+    void addDrive(const QString &dbusObjectPath, const QVariantMap &driveProperties);
+    void removeDrive(const QString &dbusObjectPath);
     void lock(const QString &dbusObjectPath);
 
     void waitPartition(Block *block);
@@ -81,6 +85,7 @@ public:
 
 
 signals:
+    void blockCreated(UDisks2::Block *block);
     void newBlock(Block *block, bool createPartition);
     void externalStoragesPopulated();
 
@@ -88,6 +93,20 @@ private slots:
     void blockCompleted();
 
 private:
+    enum State {
+        Pending  = 0x01,
+        Existing = 0x02,
+        Active   = 0x04
+    };
+    Q_DECLARE_FLAGS(States, State)
+
+    // Keys under which a block was indexed. Kept so that the block can be
+    // removed from the indexes even after its properties have changed.
+    struct IndexEntry {
+        QString devicePath;
+        QString cryptoBackingDevicePath;
+        QString cryptoBackingObjectPath;
+    };
 
     struct PartitionWaiter {
         PartitionWaiter(int timer, Block *block);
@@ -103,6 +122,14 @@ private:
 
     void complete(Block *block, bool forceAccept = false);
 
+    QMap<QString, Block *> &blocks(State state);
+    void setState(Block *block, State state);
+    Block *clearState(const QString &dbusObjectPath, State state);
+    Block *preferred(const QList<Block *> &candidates, States states = States(Pending | Existing | Active)) const;
+
+    void updateIndex(Block *block);
+    void removeIndex(const Block *block);
+
     void timerEvent(QTimerEvent *e) override;
     void updatePopulatedCheck();
 
@@ -110,6 +137,15 @@ private:
     QMap<QString, Block *> m_blockDevices;
     QMap<QString, Block *> m_pendingBlockDevices;
 
+    // Secondary indexes over the three maps above.
+    QHash<QString, States> m_states;
+    QMultiHash<QString, Block *> m_devicePathIndex;
+    QMultiHash<QString, Block *> m_cryptoBackingDevicePathIndex;
+    QMultiHash<QString, Block *> m_cryptoBackingObjectPathIndex;
+    QHash<const Block *, IndexEntry> m_indexEntries;
+
+    QMap<QString, QVariantMap> m_drives;
+
     QMap<QString, PartitionWaiter*> m_partitionWaits;
     int m_blockCount;
     bool m_populated;
@@ -32,26 +32,34 @@
 #ifndef UDISKS2_DEFINES
 #define UDISKS2_DEFINES
 
+#include <QDBusObjectPath>
 #include <QVariantMap>
 
 namespace UDisks2 {
     static const auto propertiesChangedSignal = QStringLiteral("PropertiesChanged");
     static const auto interfacesAddedSignal   = QStringLiteral("InterfacesAdded");
     static const auto interfacesRemovedSignal = QStringLiteral("InterfacesRemoved");
+    static const auto jobCompletedSignal      = QStringLiteral("Completed");
     static const auto cryptoBackingDeviceKey  = QStringLiteral("CryptoBackingDevice");
 
     typedef QMap<QString, QVariantMap> InterfacePropertyMap;
+    typedef QMap<QDBusObjectPath, InterfacePropertyMap> ObjectInterfacePropertyMap;
 }
 
 Q_DECLARE_METATYPE(UDisks2::InterfacePropertyMap)
+Q_DECLARE_METATYPE(UDisks2::ObjectInterfacePropertyMap)
 
 #define DBUS_OBJECT_MANAGER_INTERFACE    QLatin1String("org.freedesktop.DBus.ObjectManager")
 #define DBUS_OBJECT_PROPERTIES_INTERFACE QLatin1String("org.freedesktop.DBus.Properties")
 #define DBUS_GET_ALL                     QLatin1String("GetAll")
+#define DBUS_GET_MANAGED_OBJECTS         QLatin1String("GetManagedObjects")
 
 #define UDISKS2_SERVICE         QLatin1String("org.freedesktop.UDisks2")
 #define UDISKS2_PATH            QLatin1String("/org/freedesktop/UDisks2")
 #define UDISKS2_MANAGER_PATH    QLatin1String("/org/freedesktop/UDisks2/Manager")
+#define UDISKS2_BLOCK_DEVICES_PATH_PREFIX QLatin1String("/org/freedesktop/UDisks2/block_devices/")
+#define UDISKS2_DRIVES_PATH_PREFIX        QLatin1String("/org/freedesktop/UDisks2/drives/")
+#define UDISKS2_JOBS_PATH_PREFIX          QLatin1String("/org/freedesktop/UDisks2/jobs")
 
 // Interfaces
 #define UDISKS2_MANAGER_INTERFACE          QLatin1String("org.freedesktop.UDisks2.Manager")
@@ -74,6 +82,11 @@ Q_DECLARE_METATYPE(UDisks2::InterfacePropertyMap)
 // Job keys
 #define UDISKS2_JOB_KEY_OPERATION QLatin1String("Operation")
 #define UDISKS2_JOB_KEY_OBJECTS   QLatin1String("Objects")
+#define UDISKS2_JOB_KEY_PROGRESS  QLatin1String("Progress")
+#define UDISKS2_JOB_KEY_PROGRESS_VALID QLatin1String("ProgressValid")
+#define UDISKS2_JOB_KEY_BYTES     QLatin1String("Bytes")
+#define UDISKS2_JOB_KEY_RATE      QLatin1String("Rate")
+#define UDISKS2_JOB_KEY_EXPECTED_END_TIME QLatin1String("ExpectedEndTime")
 
 // Lock, Unlock, Mount, Unmount, Format
 #define UDISKS2_BLOCK_DEVICE_PATH  QString(QLatin1String("/org/freedesktop/UDisks2/block_devices/%1"))
@@ -34,10 +34,10 @@
 #include "udisks2defines.h"
 #include "logging_p.h"
 
-#include <QDBusConnection>
-
 #include <nemo-dbus/dbus.h>
 
+#include <QTimer>
+
 UDisks2::Job::Job(const QString &path, const QVariantMap &data, QObject *parent)
     : QObject(parent)
     , m_path(path)
@@ -45,18 +45,9 @@ UDisks2::Job::Job(const QString &path, const QVariantMap &data, QObject *parent)
     , m_status(Added)
     , m_completed(false)
     , m_success(false)
-    , m_connection(QDBusConnection::systemBus())
-{
-    if (!m_path.isEmpty() && !m_connection.connect(
-                UDISKS2_SERVICE,
-                m_path,
-                UDISKS2_JOB_INTERFACE,
-                QStringLiteral("Completed"),
-                this,
-                SLOT(updateCompleted(bool, QString)))) {
-        qCWarning(lcMemoryCardLog) << "Failed to connect to Job's at path" << qPrintable(m_path) << "completed signal" << qPrintable(m_connection.lastError().message());
-    }
-
+    , m_progressPending(false)
+{
+    // Completed signal is delivered through UDisks2::Monitor.
     connect(Monitor::instance(), &Monitor::errorMessage, this, [this](const QString &objectPath, const QString &errorName) {
         if (objects().contains(objectPath) && errorName == UDISKS2_ERROR_DEVICE_BUSY) {
             m_message = errorName;
@@ -83,6 +74,28 @@ void UDisks2::Job::complete(bool success)
     emit completed(success);
 }
 
+qreal UDisks2::Job::progress() const
+{
+    return value(UDISKS2_JOB_KEY_PROGRESS_VALID).toBool() ? value(UDISKS2_JOB_KEY_PROGRESS).toReal() : -1;
+}
+
+qint64 UDisks2::Job::rate() const
+{
+    return value(UDISKS2_JOB_KEY_RATE).toLongLong();
+}
+
+qint64 UDisks2::Job::bytes() const
+{
+    return value(UDISKS2_JOB_KEY_BYTES).toLongLong();
+}
+
+QDateTime UDisks2::Job::expectedEndTime() const
+{
+    // Microseconds since the epoch, zero if unknown.
+    const qint64 usecs = value(UDISKS2_JOB_KEY_EXPECTED_END_TIME).toLongLong();
+    return usecs > 0 ? QDateTime::fromMSecsSinceEpoch(usecs / 1000) : QDateTime();
+}
+
 bool UDisks2::Job::isCompleted() const
 {
     return m_completed;
@@ -154,3 +167,41 @@ void UDisks2::Job::updateCompleted(bool success, const QString &message)
     m_message = message;
     complete(success);
 }
+
+void UDisks2::Job::updateProperties(const QDBusMessage &message)
+{
+    const QList<QVariant> arguments = message.arguments();
+    if (arguments.value(0).toString() != UDISKS2_JOB_INTERFACE || isCompleted()) {
+        return;
+    }
+
+    const QVariantMap changedProperties = NemoDBus::demarshallArgument<QVariantMap>(arguments.value(1));
+    for (auto it = changedProperties.constBegin(); it != changedProperties.constEnd(); ++it) {
+        m_data.insert(it.key(), it.value());
+    }
+
+    notifyProgress();
+}
+
+void UDisks2::Job::notifyProgress()
+{
+    if (m_progressPending) {
+        return;
+    }
+
+    const qint64 elapsed = m_progressNotified.isValid() ? m_progressNotified.elapsed() : ProgressInterval;
+    if (elapsed >= ProgressInterval) {
+        m_progressNotified.start();
+        emit progressChanged();
+    } else {
+        // Deliver the latest values once the interval has passed.
+        m_progressPending = true;
+        QTimer::singleShot(ProgressInterval - elapsed, this, [this]() {
+            m_progressPending = false;
+            if (!isCompleted()) {
+                m_progressNotified.start();
+                emit progressChanged();
+            }
+        });
+    }
+}
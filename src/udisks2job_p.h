@@ -33,7 +33,9 @@
 #define UDISKS2_JOB_H
 
 #include <QObject>
-#include <QDBusConnection>
+#include <QDateTime>
+#include <QDBusMessage>
+#include <QElapsedTimer>
 #include <QString>
 #include <QVariantMap>
 
@@ -70,6 +72,13 @@ public:
 
     QStringList objects() const;
 
+    // Progress is -1 while UDisks2 does not know it. Rate is in bytes per
+    // second and zero when unknown, so is the total of bytes processed.
+    qreal progress() const;
+    qint64 rate() const;
+    qint64 bytes() const;
+    QDateTime expectedEndTime() const;
+
     QString path() const;
     QVariant value(const QString &key) const;
 
@@ -80,11 +89,18 @@ public:
 
 signals:
     void completed(bool success);
+    // Rate limited to one emission per ProgressInterval.
+    void progressChanged();
 
 private slots:
     void updateCompleted(bool success, const QString &message);
 
 private:
+    void updateProperties(const QDBusMessage &message);
+    void notifyProgress();
+
+    static const int ProgressInterval = 500;
+
     QString m_path;
     QVariantMap m_data;
     Status m_status;
@@ -92,8 +108,10 @@ private:
     QString m_message;
     bool m_completed;
     bool m_success;
+    bool m_progressPending;
+    QElapsedTimer m_progressNotified;
 
-    QDBusConnection m_connection;
+    friend class Monitor;
 };
 }
 
@@ -37,6 +37,8 @@
 #include "nemo-dbus/dbus.h"
 
 #include "partitionmanager_p.h"
+#include "dbuscallstatistics_p.h"
+#include "filesystemcapabilities_p.h"
 #include "logging_p.h"
 
 #include <QDBusConnection>
@@ -44,6 +46,10 @@
 #include <QDBusError>
 #include <QDBusInterface>
 #include <QDBusMetaType>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <limits>
 
 struct ErrorEntry {
     Partition::Error errorCode;
@@ -70,6 +76,9 @@ static const ErrorEntry dbus_error_entries[] =
     { Partition::ErrorDeviceBusy,             "org.freedesktop.UDisks2.Error.DeviceBusy" }
 };
 
+// How long a deferred operation may wait for its condition.
+static const int OperationTimeout = 60000;
+
 UDisks2::Monitor *UDisks2::Monitor::sharedInstance = nullptr;
 
 UDisks2::Monitor *UDisks2::Monitor::instance()
@@ -87,7 +96,12 @@ UDisks2::Monitor::Monitor(PartitionManagerPrivate *manager, QObject *parent)
     Q_ASSERT(!sharedInstance);
     sharedInstance = this;
 
+    m_operationClock.start();
+    m_operationTimer.setSingleShot(true);
+    connect(&m_operationTimer, &QTimer::timeout, this, &Monitor::operationTimeout);
+
     qDBusRegisterMetaType<UDisks2::InterfacePropertyMap>();
+    qDBusRegisterMetaType<UDisks2::ObjectInterfacePropertyMap>();
     QDBusConnection systemBus = QDBusConnection::systemBus();
 
     connect(systemBus.interface(), &QDBusConnectionInterface::callWithCallbackFailed,
@@ -123,9 +137,43 @@ UDisks2::Monitor::Monitor(PartitionManagerPrivate *manager, QObject *parent)
         qCWarning(lcMemoryCardLog) << "Failed to connect to interfaces removed signal:" << qPrintable(systemBus.lastError().message());
     }
 
+    // Single subscriptions for all UDisks2 objects instead of one match rule per block and job.
+    // Empty path matches any object path of the UDisks2 service i.e. everything under UDISKS2_PATH.
+    if (!systemBus.connect(
+                UDISKS2_SERVICE,
+                QString(),
+                DBUS_OBJECT_PROPERTIES_INTERFACE,
+                propertiesChangedSignal,
+                this,
+                SLOT(propertiesChanged(QDBusMessage)))) {
+        qCWarning(lcMemoryCardLog) << "Failed to connect to properties changed signal:" << qPrintable(systemBus.lastError().message());
+    }
+
+    if (!systemBus.connect(
+                UDISKS2_SERVICE,
+                QString(),
+                UDISKS2_JOB_INTERFACE,
+                jobCompletedSignal,
+                this,
+                SLOT(jobCompleted(QDBusMessage)))) {
+        qCWarning(lcMemoryCardLog) << "Failed to connect to job completed signal:" << qPrintable(systemBus.lastError().message());
+    }
+
+    connect(m_blockDevices, &BlockDevices::blockCreated, this, &Monitor::registerBlock);
+
     getBlockDevices();
 
     connect(m_blockDevices, &BlockDevices::newBlock, this, &Monitor::handleNewBlock);
+
+    // Whether a partition can be mounted depends on the file systems UDisks2
+    // reports, which may arrive after the partitions were created.
+    connect(FileSystemCapabilities::instance(), &FileSystemCapabilities::fileSystemsChanged, this, [this]() {
+        for (Block *block : m_blocks) {
+            if (m_blockDevices->contains(block->path())) {
+                updatePartitionProperties(block);
+            }
+        }
+    });
 }
 
 UDisks2::Monitor::~Monitor()
@@ -141,6 +189,11 @@ UDisks2::Monitor::~Monitor()
 // TODO : Move lock, unlock, mount, unmount, format inside udisks2block.cpp
 // unlock, mount, format should be considered completed only after file system interface re-appears for the block.
 void UDisks2::Monitor::lock(const QString &devicePath)
+{
+    scheduleLock(devicePath);
+}
+
+void UDisks2::Monitor::scheduleLock(const QString &devicePath)
 {
     QVariantList arguments;
     QVariantMap options;
@@ -152,7 +205,7 @@ void UDisks2::Monitor::lock(const QString &devicePath)
 
         // Unmount if mounted.
         if (!block->mountPath().isEmpty()) {
-            m_operationQueue.enqueue(Operation(UDISKS2_ENCRYPTED_LOCK, devicePath));
+            enqueueOperation(block->device(), Operation(UDISKS2_ENCRYPTED_LOCK, devicePath), Operation::Unmounted);
             unmount(block->device());
         } else {
             startLuksOperation(devicePath, UDISKS2_ENCRYPTED_LOCK, m_blockDevices->objectPath(devicePath), arguments);
@@ -227,13 +280,17 @@ void UDisks2::Monitor::format(const QString &devicePath, const QString &filesyst
             block->setFormatting(true);
         }
 
-        // Lock unlocked block device before formatting.
+        // Lock unlocked block device before formatting, the lock may itself wait for an
+        // unmount on the same queue, which the format then waits behind.
         if (!partition->cryptoBackingDevicePath.isEmpty()) {
-            lock(partition->cryptoBackingDevicePath);
-            m_operationQueue.enqueue(Operation(UDISKS2_BLOCK_FORMAT, partition->cryptoBackingDevicePath, objectPath, filesystemType, arguments));
+            scheduleLock(partition->cryptoBackingDevicePath);
+            enqueueOperation(partition->cryptoBackingDevicePath,
+                             Operation(UDISKS2_BLOCK_FORMAT, partition->cryptoBackingDevicePath, objectPath, filesystemType, arguments),
+                             Operation::BlockAdded);
             return;
         } else if (partition->status == Partition::Mounted) {
-            m_operationQueue.enqueue(Operation(UDISKS2_BLOCK_FORMAT, devicePath, objectPath, filesystemType, arguments));
+            enqueueOperation(devicePath, Operation(UDISKS2_BLOCK_FORMAT, devicePath, objectPath, filesystemType, arguments),
+                             Operation::Unmounted);
             unmount(devicePath);
             return;
         }
@@ -249,9 +306,11 @@ void UDisks2::Monitor::interfacesAdded(const QDBusObjectPath &objectPath, const
     qCInfo(lcMemoryCardLog) << "UDisks dump interface:" << interfaces;
     // A device must have file system or partition so that it can added to the model.
     // Devices without partition table can have a filesystem interface.
-    if (path.startsWith(QStringLiteral("/org/freedesktop/UDisks2/block_devices/"))) {
+    if (path.startsWith(UDISKS2_BLOCK_DEVICES_PATH_PREFIX)) {
         m_blockDevices->createBlockDevice(path, interfaces);
-    } else if (path.startsWith(QStringLiteral("/org/freedesktop/UDisks2/jobs"))) {
+    } else if (path.startsWith(UDISKS2_DRIVES_PATH_PREFIX) && interfaces.contains(UDISKS2_DRIVE_INTERFACE)) {
+        m_blockDevices->addDrive(path, interfaces.value(UDISKS2_DRIVE_INTERFACE));
+    } else if (path.startsWith(UDISKS2_JOBS_PATH_PREFIX)) {
         QVariantMap dict = interfaces.value(UDISKS2_JOB_INTERFACE);
         QString operation = dict.value(UDISKS2_JOB_KEY_OPERATION, QString()).toString();
         if (operation == UDISKS2_JOB_OP_ENC_LOCK ||
@@ -263,9 +322,14 @@ void UDisks2::Monitor::interfacesAdded(const QDBusObjectPath &objectPath, const
             UDisks2::Job *job = new UDisks2::Job(path, dict);
             updatePartitionStatus(job, true);
 
+            connect(job, &UDisks2::Job::progressChanged, this, [this]() {
+                updatePartitionProgress(qobject_cast<UDisks2::Job *>(sender()));
+            });
+
             connect(job, &UDisks2::Job::completed, this, [this](bool success) {
                 UDisks2::Job *job = qobject_cast<UDisks2::Job *>(sender());
                 job->dumpInfo();
+                updatePartitionProgress(job);
                 if (job->operation() != Job::Lock) {
                     updatePartitionStatus(job, success);
                 } else {
@@ -310,11 +374,39 @@ void UDisks2::Monitor::interfacesRemoved(const QDBusObjectPath &objectPath, cons
         m_manager->remove(removedPartitions);
 
         m_blockDevices->remove(path);
+    } else if (path.startsWith(UDISKS2_DRIVES_PATH_PREFIX) && interfaces.contains(UDISKS2_DRIVE_INTERFACE)) {
+        m_blockDevices->removeDrive(path);
     } else {
         m_blockDevices->removeInterfaces(path, interfaces);
     }
 }
 
+void UDisks2::Monitor::propertiesChanged(const QDBusMessage &message)
+{
+    const QString path = message.path();
+    if (path.startsWith(UDISKS2_JOBS_PATH_PREFIX)) {
+        if (Job *job = m_jobsToWait.value(path, nullptr)) {
+            job->updateProperties(message);
+        }
+        return;
+    } else if (!path.startsWith(UDISKS2_BLOCK_DEVICES_PATH_PREFIX)) {
+        return;
+    }
+
+    const QList<Block *> blocks = m_blocks.values(path);
+    for (Block *block : blocks) {
+        block->updateProperties(message);
+    }
+}
+
+void UDisks2::Monitor::jobCompleted(const QDBusMessage &message)
+{
+    if (Job *job = m_jobsToWait.value(message.path(), nullptr)) {
+        const QList<QVariant> arguments = message.arguments();
+        job->updateCompleted(arguments.value(0).toBool(), arguments.value(1).toString());
+    }
+}
+
 void UDisks2::Monitor::setPartitionProperties(QExplicitlySharedDataPointer<PartitionPrivate> &partition, const UDisks2::Block *blockDevice)
 {
     QString label = blockDevice->idLabel();
@@ -325,7 +417,7 @@ void UDisks2::Monitor::setPartitionProperties(QExplicitlySharedDataPointer<Parti
     qCDebug(lcMemoryCardLog) << "Set partition properties";
     blockDevice->dumpInfo();
 
-    partition->devicePath = blockDevice->device();
+    m_manager->setDevicePath(partition, blockDevice->device());
     QString deviceName = partition->devicePath.section(QChar('/'), 2);
     partition->deviceName = deviceName;
     partition->deviceRoot = deviceRoot.match(deviceName).hasMatch();
@@ -333,9 +425,9 @@ void UDisks2::Monitor::setPartitionProperties(QExplicitlySharedDataPointer<Parti
     partition->mountPath = blockDevice->mountPath();
     partition->deviceLabel = label;
     partition->filesystemType = blockDevice->idType();
-    partition->isSupportedFileSystemType = m_manager->supportedFileSystems().contains(partition->filesystemType);
+    partition->isSupportedFileSystemType = m_manager->isSupportedFileSystem(partition->filesystemType);
     partition->readOnly = blockDevice->isReadOnly();
-    partition->canMount = blockDevice->isMountable() && m_manager->supportedFileSystems().contains(partition->filesystemType);
+    partition->canMount = blockDevice->isMountable() && partition->isSupportedFileSystemType;
 
     if (blockDevice->isFormatting()) {
         partition->status = Partition::Formatting;
@@ -369,15 +461,15 @@ void UDisks2::Monitor::setPartitionProperties(QExplicitlySharedDataPointer<Parti
 
 void UDisks2::Monitor::updatePartitionProperties(const UDisks2::Block *blockDevice)
 {
-    bool hasCryptoBackingDevice = blockDevice->hasCryptoBackingDevice();
-    const QString cryptoBackingDevicePath = blockDevice->cryptoBackingDevicePath();
+    PartitionManagerPrivate::Partitions partitions = m_manager->findPartitions(blockDevice->device());
+    if (blockDevice->hasCryptoBackingDevice()) {
+        partitions += m_manager->findPartitions(blockDevice->cryptoBackingDevicePath());
+    }
 
-    for (auto partition : m_manager->m_partitions) {
-        if ((partition->devicePath == blockDevice->device()) || (hasCryptoBackingDevice && (partition->devicePath == cryptoBackingDevicePath))) {
-            setPartitionProperties(partition, blockDevice);
-            partition->valid = true;
-            m_manager->refresh(partition.data());
-        }
+    for (auto partition : partitions) {
+        setPartitionProperties(partition, blockDevice);
+        partition->valid = true;
+        m_manager->refresh(partition.data());
     }
 }
 
@@ -460,6 +552,29 @@ void UDisks2::Monitor::updatePartitionStatus(const UDisks2::Job *job, bool succe
     }
 }
 
+void UDisks2::Monitor::updatePartitionProgress(const UDisks2::Job *job)
+{
+    PartitionManagerPrivate::Partitions affectedPartitions;
+    lookupPartitions(affectedPartitions, job->objects());
+
+    const bool running = !job->isCompleted();
+    const qreal progress = running ? job->progress() : -1;
+    const qint64 rate = running ? job->rate() : 0;
+    const QDateTime expectedEndTime = running ? job->expectedEndTime() : QDateTime();
+
+    for (auto partition : affectedPartitions) {
+        if (partition->operationProgress != progress
+                || partition->operationRate != rate
+                || partition->operationExpectedEndTime != expectedEndTime) {
+            partition->operationProgress = progress;
+            partition->operationRate = rate;
+            partition->operationExpectedEndTime = expectedEndTime;
+            // No need to re-read the file system, only notify.
+            m_manager->partitionChangedLater(partition);
+        }
+    }
+}
+
 void UDisks2::Monitor::startLuksOperation(const QString &devicePath, const QString &dbusMethod, const QString &dbusObjectPath, const QVariantList &arguments)
 {
     Q_ASSERT(dbusMethod == UDISKS2_ENCRYPTED_LOCK || dbusMethod == UDISKS2_ENCRYPTED_UNLOCK);
@@ -474,10 +589,13 @@ void UDisks2::Monitor::startLuksOperation(const QString &devicePath, const QStri
                                     UDISKS2_ENCRYPTED_INTERFACE,
                                     QDBusConnection::systemBus());
 
+    QElapsedTimer callTimer;
+    callTimer.start();
     QDBusPendingCall pendingCall = udisks2Interface.asyncCallWithArgumentList(dbusMethod, arguments);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
     connect(watcher, &QDBusPendingCallWatcher::finished,
-            this, [this, devicePath, dbusMethod](QDBusPendingCallWatcher *watcher) {
+            this, [this, devicePath, dbusMethod, callTimer](QDBusPendingCallWatcher *watcher) {
+        DBusCallStatistics::instance()->record(UDISKS2_ENCRYPTED_INTERFACE, dbusMethod, callTimer.nsecsElapsed(), !watcher->isError());
         if (watcher->isValid() && watcher->isFinished()) {
             if (dbusMethod == UDISKS2_ENCRYPTED_LOCK) {
                 emit status(devicePath, Partition::Locked);
@@ -536,10 +654,13 @@ void UDisks2::Monitor::startMountOperation(const QString &devicePath, const QStr
                                     UDISKS2_FILESYSTEM_INTERFACE,
                                     QDBusConnection::systemBus());
 
+    QElapsedTimer callTimer;
+    callTimer.start();
     QDBusPendingCall pendingCall = udisks2Interface.asyncCallWithArgumentList(dbusMethod, arguments);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
     connect(watcher, &QDBusPendingCallWatcher::finished,
-            this, [this, devicePath, dbusMethod](QDBusPendingCallWatcher *watcher) {
+            this, [this, devicePath, dbusMethod, callTimer](QDBusPendingCallWatcher *watcher) {
+        DBusCallStatistics::instance()->record(UDISKS2_FILESYSTEM_INTERFACE, dbusMethod, callTimer.nsecsElapsed(), !watcher->isError());
         if (watcher->isValid() && watcher->isFinished()) {
             Block *block = m_blockDevices->find(devicePath);
             if (block && block->isFormatting()) {
@@ -556,8 +677,10 @@ void UDisks2::Monitor::startMountOperation(const QString &devicePath, const QStr
 
             qCWarning(lcMemoryCardLog) << dbusMethod << "error:" << errorCStr;
 
+            Partition::Error errorCode = Partition::ErrorFailed;
             for (uint i = 0; i < sizeof(dbus_error_entries) / sizeof(ErrorEntry); i++) {
                 if (strcmp(dbus_error_entries[i].dbusErrorName, errorCStr) == 0) {
+                    errorCode = dbus_error_entries[i].errorCode;
                     if (dbusMethod == UDISKS2_FILESYSTEM_MOUNT) {
                         emit mountError(dbus_error_entries[i].errorCode);
                         break;
@@ -575,6 +698,8 @@ void UDisks2::Monitor::startMountOperation(const QString &devicePath, const QStr
             } else if (dbusMethod == UDISKS2_FILESYSTEM_UNMOUNT) {
                 // All other errors will revert back the previous state.
                 emit status(devicePath, Partition::Mounted);
+                // Nothing waiting for this unmount can proceed.
+                failOperations(devicePath, errorCode);
             } else if (dbusMethod == UDISKS2_FILESYSTEM_MOUNT) {
                 // All other errors will revert back the previous state.
                 emit status(devicePath, Partition::Unmounted);
@@ -598,11 +723,7 @@ void UDisks2::Monitor::lookupPartitions(PartitionManagerPrivate::Partitions &aff
 {
     QStringList blockDevs = m_blockDevices->devicePaths(objects);
     for (const QString &dev : blockDevs) {
-        for (auto partition : m_manager->m_partitions) {
-            if (partition->devicePath == dev) {
-                affectedPartitions << partition;
-            }
-        }
+        affectedPartitions << m_manager->findPartitions(dev);
     }
 }
 
@@ -624,10 +745,14 @@ void UDisks2::Monitor::doFormat(const QString &devicePath, const QString &dbusOb
                                     UDISKS2_BLOCK_INTERFACE,
                                     QDBusConnection::systemBus());
 
+    QElapsedTimer callTimer;
+    callTimer.start();
     QDBusPendingCall pendingCall = blockDeviceInterface.asyncCall(UDISKS2_BLOCK_FORMAT, filesystemType, arguments);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
     connect(watcher, &QDBusPendingCallWatcher::finished,
-            this, [this, devicePath, dbusObjectPath, arguments](QDBusPendingCallWatcher *watcher) {
+            this, [this, devicePath, dbusObjectPath, arguments, callTimer](QDBusPendingCallWatcher *watcher) {
+        DBusCallStatistics::instance()->record(UDISKS2_BLOCK_INTERFACE, UDISKS2_BLOCK_FORMAT,
+                                               callTimer.nsecsElapsed(), !watcher->isError());
         if (watcher->isValid() && watcher->isFinished()) {
             emit status(devicePath, Partition::Formatted);
         } else if (watcher->isError()) {
@@ -653,23 +778,27 @@ void UDisks2::Monitor::doFormat(const QString &devicePath, const QString &dbusOb
 
 void UDisks2::Monitor::getBlockDevices()
 {
-    QDBusInterface managerInterface(UDISKS2_SERVICE,
-                                    UDISKS2_MANAGER_PATH,
-                                    UDISKS2_MANAGER_INTERFACE,
-                                    QDBusConnection::systemBus());
-    QDBusPendingCall pendingCall = managerInterface.asyncCallWithArgumentList(
-                QStringLiteral("GetBlockDevices"),
-                QVariantList() << QVariantMap());
+    // One round trip returns every block device and drive together with
+    // the properties of all their interfaces.
+    QDBusInterface objectManagerInterface(UDISKS2_SERVICE,
+                                          UDISKS2_PATH,
+                                          DBUS_OBJECT_MANAGER_INTERFACE,
+                                          QDBusConnection::systemBus());
+    QElapsedTimer callTimer;
+    callTimer.start();
+    QDBusPendingCall pendingCall = objectManagerInterface.asyncCall(DBUS_GET_MANAGED_OBJECTS);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
-    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, callTimer](QDBusPendingCallWatcher *watcher) {
+        DBusCallStatistics::instance()->record(DBUS_OBJECT_MANAGER_INTERFACE, DBUS_GET_MANAGED_OBJECTS,
+                                               callTimer.nsecsElapsed(), !watcher->isError());
         if (watcher->isValid() && watcher->isFinished()) {
-            QDBusPendingReply<QList<QDBusObjectPath> > reply = *watcher;
-            const QList<QDBusObjectPath> blockDevicePaths = reply.argumentAt<0>();
-            m_blockDevices->createBlockDevices(blockDevicePaths);
+            QDBusPendingReply<UDisks2::ObjectInterfacePropertyMap> reply = *watcher;
+            m_blockDevices->createBlockDevices(reply.argumentAt<0>());
         } else if (watcher->isError()) {
             QDBusError error = watcher->error();
             qCWarning(lcMemoryCardLog) << "Unable to enumerate block devices:" << error.name() << error.message();
         }
+        watcher->deleteLater();
     });
 }
 
@@ -678,13 +807,11 @@ void UDisks2::Monitor::connectSignals(UDisks2::Block *block)
     connect(block, &UDisks2::Block::formatted, this, [this]() {
         UDisks2::Block *block = qobject_cast<UDisks2::Block *>(sender());
         if (m_blockDevices->contains(block->path())) {
-            for (auto partition : m_manager->m_partitions) {
-                if (partition->devicePath == block->device()) {
-                    partition->status = Partition::Formatted;
-                    partition->activeState = QStringLiteral("inactive");
-                    partition->valid = true;
-                    m_manager->refresh(partition.data());
-                }
+            for (auto partition : m_manager->findPartitions(block->device())) {
+                partition->status = Partition::Formatted;
+                partition->activeState = QStringLiteral("inactive");
+                partition->valid = true;
+                m_manager->refresh(partition.data());
             }
         }
     }, Qt::UniqueConnection);
@@ -700,9 +827,7 @@ void UDisks2::Monitor::connectSignals(UDisks2::Block *block)
     connect(block, &UDisks2::Block::mountPathChanged, this, [this]() {
         UDisks2::Block *block = qobject_cast<UDisks2::Block *>(sender());
         // Both updatePartitionStatus and updatePartitionProperties
-        // emits partition refresh => latter one is enough.
-
-        m_manager->blockSignals(true);
+        // refresh the partition, the manager coalesces the change notifications.
         QVariantMap data;
         data.insert(UDISKS2_JOB_KEY_OPERATION, block->mountPath().isEmpty() ? UDISKS2_JOB_OP_FS_UNMOUNT : UDISKS2_JOB_OP_FS_MOUNT);
         data.insert(UDISKS2_JOB_KEY_OBJECTS, QStringList() << block->path());
@@ -710,30 +835,25 @@ void UDisks2::Monitor::connectSignals(UDisks2::Block *block)
         UDisks2::Job tmpJob(QString(), data);
         tmpJob.complete(true);
         updatePartitionStatus(&tmpJob, true);
-        m_manager->blockSignals(false);
 
         updatePartitionProperties(block);
 
-        if (!m_operationQueue.isEmpty()) {
-            Operation op = m_operationQueue.head();
-            if (op.command == UDISKS2_BLOCK_FORMAT && block->mountPath().isEmpty()) {
-                m_operationQueue.dequeue();
-                doFormat(op.devicePath, op.dbusObjectPath, op.filesystemType, op.arguments);
-            } else if (op.command == UDISKS2_ENCRYPTED_LOCK && block->mountPath().isEmpty()) {
-                m_operationQueue.dequeue();
-                lock(op.devicePath);
-            }
+        if (block->mountPath().isEmpty()) {
+            advanceOperations(block->device(), Operation::Unmounted);
         }
     }, Qt::UniqueConnection);
 
     connect(block, &UDisks2::Block::blockRemoved, this, [this](const QString &device) {
-        PartitionManagerPrivate::Partitions removedPartitions;
-        for (auto partition : m_manager->m_partitions) {
-            if (partition->devicePath == device) {
-                removedPartitions << partition;
-            }
-        }
-        m_manager->remove(removedPartitions);
+        m_manager->remove(m_manager->findPartitions(device));
+    });
+}
+
+void UDisks2::Monitor::registerBlock(UDisks2::Block *block)
+{
+    const QString path = block->path();
+    m_blocks.insert(path, block);
+    connect(block, &QObject::destroyed, this, [this, path, block]() {
+        m_blocks.remove(path, block);
     });
 }
 
@@ -749,14 +869,8 @@ void UDisks2::Monitor::handleNewBlock(UDisks2::Block *block, bool forceCreatePar
         createPartition(block);
 
         if (block->isFormatting()) {
-            if (!m_operationQueue.isEmpty()) {
-                Operation op = m_operationQueue.head();
-                if (op.command == UDISKS2_BLOCK_FORMAT) {
-                    m_operationQueue.dequeue();
-                    QMetaObject::invokeMethod(this, "doFormat", Qt::QueuedConnection,
-                                              Q_ARG(QString, op.devicePath), Q_ARG(QString, op.dbusObjectPath),
-                                              Q_ARG(QString, op.filesystemType), Q_ARG(QVariantMap, op.arguments));
-                }
+            if (m_operations.contains(block->device())) {
+                advanceOperations(block->device(), Operation::BlockAdded);
             } else {
                 qCDebug(lcMemoryCardLog) << "Formatting cannot be executed. Is block mounted:" << !block->mountPath().isEmpty();
             }
@@ -766,3 +880,117 @@ void UDisks2::Monitor::handleNewBlock(UDisks2::Block *block, bool forceCreatePar
     connectSignals(block);
 
 }
+
+void UDisks2::Monitor::enqueueOperation(const QString &device, Operation operation, Operation::Condition condition)
+{
+    operation.condition = condition;
+    operation.deadline = m_operationClock.elapsed() + OperationTimeout;
+
+    qCDebug(lcMemoryCardLog) << "Queue" << operation.command << operation.devicePath << "on" << device;
+
+    m_operations[device].enqueue(operation);
+    scheduleOperationTimeout();
+}
+
+void UDisks2::Monitor::advanceOperations(const QString &device, Operation::Condition condition)
+{
+    // Every operation at the head waiting for this condition runs now.
+    QVector<Operation> ready;
+    auto queue = m_operations.find(device);
+    while (queue != m_operations.end() && queue->head().condition == condition) {
+        ready.append(queue->dequeue());
+        if (queue->isEmpty()) {
+            m_operations.erase(queue);
+            queue = m_operations.end();
+        } else {
+            // The next operation gets its own time window from now on.
+            queue->head().deadline = m_operationClock.elapsed() + OperationTimeout;
+        }
+    }
+
+    if (ready.isEmpty()) {
+        return;
+    }
+    scheduleOperationTimeout();
+
+    for (const Operation &operation : ready) {
+        runOperation(operation);
+    }
+}
+
+void UDisks2::Monitor::runOperation(const Operation &operation)
+{
+    qCDebug(lcMemoryCardLog) << "Run" << operation.command << operation.devicePath;
+
+    if (operation.command == UDISKS2_ENCRYPTED_LOCK) {
+        lock(operation.devicePath);
+    } else if (operation.command == UDISKS2_BLOCK_FORMAT) {
+        QMetaObject::invokeMethod(this, "doFormat", Qt::QueuedConnection,
+                                  Q_ARG(QString, operation.devicePath), Q_ARG(QString, operation.dbusObjectPath),
+                                  Q_ARG(QString, operation.filesystemType), Q_ARG(QVariantMap, operation.arguments));
+    }
+}
+
+// Fails every operation queued on the device.
+void UDisks2::Monitor::failOperations(const QString &device, Partition::Error error)
+{
+    QQueue<Operation> failed = m_operations.take(device);
+    scheduleOperationTimeout();
+
+    for (const Operation &operation : failed) {
+        operationFailed(operation, error);
+    }
+}
+
+void UDisks2::Monitor::operationFailed(const Operation &operation, Partition::Error error)
+{
+    qCWarning(lcMemoryCardLog) << operation.command << operation.devicePath << "failed:" << error;
+
+    Block *block = m_blockDevices->find(operation.devicePath);
+    if (operation.command == UDISKS2_BLOCK_FORMAT) {
+        if (block) {
+            block->setFormatting(false);
+        }
+        emit formatError(error);
+    } else if (operation.command == UDISKS2_ENCRYPTED_LOCK) {
+        emit lockError(error);
+    }
+
+    // Resynchronize the partition state with the block.
+    if (block) {
+        updatePartitionProperties(block);
+    }
+}
+
+void UDisks2::Monitor::operationTimeout()
+{
+    const qint64 now = m_operationClock.elapsed();
+
+    QStringList expired;
+    for (auto it = m_operations.constBegin(); it != m_operations.constEnd(); ++it) {
+        if (it->head().deadline <= now) {
+            expired.append(it.key());
+        }
+    }
+
+    for (const QString &device : expired) {
+        qCWarning(lcMemoryCardLog) << "Operations on" << device << "timed out";
+        failOperations(device, Partition::ErrorTimedout);
+    }
+
+    scheduleOperationTimeout();
+}
+
+void UDisks2::Monitor::scheduleOperationTimeout()
+{
+    qint64 deadline = std::numeric_limits<qint64>::max();
+    for (const QQueue<Operation> &queue : m_operations) {
+        deadline = std::min(deadline, queue.head().deadline);
+    }
+
+    if (m_operations.isEmpty()) {
+        m_operationTimer.stop();
+    } else {
+        m_operationTimer.start(std::max<qint64>(deadline - m_operationClock.elapsed(), 0));
+    }
+}
@@ -33,10 +33,14 @@
 #define UDISKS2_MONITOR_H
 
 #include <QObject>
+#include <QDBusMessage>
 #include <QDBusObjectPath>
+#include <QElapsedTimer>
 #include <QExplicitlySharedDataPointer>
+#include <QMultiHash>
 #include <QRegularExpression>
 #include <QQueue>
+#include <QTimer>
 #include <QVariantList>
 
 #include "partitionmodel.h"
@@ -53,8 +57,16 @@ class Block;
 class BlockDevices;
 class Job;
 
+// An operation deferred until its device reaches the given condition. The
+// operations queued on a device run in order, each once the ones before it
+// have run and its own condition has been reached.
 struct Operation
 {
+    enum Condition {
+        Unmounted,      // File system of the queue's device got unmounted
+        BlockAdded      // Block of the queue's device (re)appeared e.g. after locking
+    };
+
     Operation(const QString &command, const QString &devicePath, const QString &dbusObjectPath = QString(), const QString &filesystemType = QString(), const QVariantMap &arguments  = QVariantMap())
         : command(command)
         , devicePath(devicePath)
@@ -68,6 +80,9 @@ struct Operation
     QString dbusObjectPath;
     QString filesystemType;
     QVariantMap arguments;
+
+    Condition condition = Unmounted;
+    qint64 deadline = 0;
 };
 
 class Monitor : public QObject
@@ -99,29 +114,49 @@ signals:
 private slots:
     void interfacesAdded(const QDBusObjectPath &objectPath, const UDisks2::InterfacePropertyMap &interfaces);
     void interfacesRemoved(const QDBusObjectPath &objectPath, const QStringList &interfaces);
+    void propertiesChanged(const QDBusMessage &message);
+    void jobCompleted(const QDBusMessage &message);
     void doFormat(const QString &devicePath, const QString &dbusObjectPath, const QString &filesystemType, const QVariantMap &arguments);
     void handleNewBlock(UDisks2::Block *block, bool forceCreatePartition);
+    void operationTimeout();
 
 private:
     void setPartitionProperties(QExplicitlySharedDataPointer<PartitionPrivate> &partition, const Block *blockDevice);
     void updatePartitionProperties(const Block *blockDevice);
     void updatePartitionStatus(const Job *job, bool success);
+    void updatePartitionProgress(const Job *job);
 
     void startLuksOperation(const QString &devicePath, const QString &dbusMethod, const QString &dbusObjectPath, const QVariantList &arguments);
     void startMountOperation(const QString &devicePath, const QString &dbusMethod, const QString &dbusObjectPath, const QVariantList &arguments);
+    void scheduleLock(const QString &devicePath);
+
+    // Per device FIFO queues of deferred operations. Queues of different
+    // devices progress and time out independently of each other.
+    void enqueueOperation(const QString &device, Operation operation, Operation::Condition condition);
+    void advanceOperations(const QString &device, Operation::Condition condition);
+    void runOperation(const Operation &operation);
+    void failOperations(const QString &device, Partition::Error error);
+    void operationFailed(const Operation &operation, Partition::Error error);
+    void scheduleOperationTimeout();
+
     void lookupPartitions(PartitionManagerPrivate::Partitions &affectedPartitions, const QStringList &objects);
 
     void createPartition(const Block *block);
     void getBlockDevices();
     void connectSignals(UDisks2::Block *block);
+    void registerBlock(UDisks2::Block *block);
 
 private:
     static Monitor *sharedInstance;
 
     QExplicitlySharedDataPointer<PartitionManagerPrivate> m_manager;
     QMap<QString, Job *> m_jobsToWait;
+    // All living blocks by D-Bus object path, for dispatching property changes.
+    QMultiHash<QString, Block *> m_blocks;
 
-    QQueue<Operation> m_operationQueue;
+    QHash<QString, QQueue<Operation>> m_operations;
+    QTimer m_operationTimer;
+    QElapsedTimer m_operationClock;
 
     BlockDevices *m_blockDevices;
 };
@@ -4,6 +4,13 @@ src_plugins.subdir = src/plugin
 src_plugins.target = sub-plugins
 src_plugins.depends = src
 
+tests_udisks2.subdir = tests/bm_udisks2
+tests_udisks2.target = sub-tests-udisks2
+tests_udisks2.depends = src
+
+tests_timezoneinfo.subdir = tests/ut_timezoneinfo
+tests_timezoneinfo.target = sub-tests-timezoneinfo
+
 OTHER_FILES += rpm/nemo-qml-plugin-systemsettings.spec
 
-SUBDIRS = src src_plugins setlocale tests translations
+SUBDIRS = src src_plugins setlocale tests tests_timezoneinfo tests_udisks2 translations
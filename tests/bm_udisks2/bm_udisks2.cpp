@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "bm_udisks2.h"
+#include "mockudisks2.h"
+
+#include <partitionmanager.h>
+#include <partitionmodel.h>
+
+#include <QtTest>
+#include <QDBusConnection>
+#include <QProcess>
+
+#include <time.h>
+
+// Runs the UDisks2 monitoring stack against MockUDisks2 on a private bus.
+// The bus is exposed to the library as the system bus through
+// DBUS_SYSTEM_BUS_ADDRESS. BM_UDISKS2_DEVICES and BM_UDISKS2_STORM set the
+// number of devices present at startup and hotplugged at once.
+
+static const int Timeout = 120000;
+static const char *MockConnectionName = "bm_udisks2_mock";
+
+static qint64 threadCpuTime()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return qint64(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+}
+
+static int environmentValue(const char *name, int defaultValue)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : defaultValue;
+}
+
+Bm_UDisks2::Bm_UDisks2()
+    : m_bus(nullptr)
+    , m_mock(nullptr)
+    , m_manager(nullptr)
+    , m_model(nullptr)
+    , m_initialDevices(environmentValue("BM_UDISKS2_DEVICES", 200))
+    , m_stormDevices(environmentValue("BM_UDISKS2_STORM", 200))
+{
+}
+
+void Bm_UDisks2::initTestCase()
+{
+    m_bus = new QProcess(this);
+    m_bus->start(QStringLiteral("dbus-daemon"),
+                 QStringList() << QStringLiteral("--session") << QStringLiteral("--nofork") << QStringLiteral("--print-address=1"));
+    if (!m_bus->waitForStarted()) {
+        QSKIP("dbus-daemon is not available");
+    }
+    QVERIFY(m_bus->waitForReadyRead(10000));
+    const QByteArray address = m_bus->readLine().trimmed();
+    QVERIFY(!address.isEmpty());
+
+    // Must happen before anything touches QDBusConnection::systemBus().
+    qputenv("DBUS_SYSTEM_BUS_ADDRESS", address);
+
+    MockUDisks2::registerMetaTypes();
+    QDBusConnection connection = QDBusConnection::connectToBus(QString::fromUtf8(address), QLatin1String(MockConnectionName));
+    QVERIFY(connection.isConnected());
+
+    // QtDBus calls handleMessage() of a virtual object directly on its own
+    // D-Bus thread, so the mock does not compete with the library for the
+    // main thread that is measured.
+    m_mock = new MockUDisks2(connection);
+
+    QVERIFY(connection.registerVirtualObject(QStringLiteral("/org/freedesktop/UDisks2"), m_mock, QDBusConnection::SubPath));
+    QVERIFY(connection.registerService(QStringLiteral("org.freedesktop.UDisks2")));
+
+    m_mock->addDevices(m_initialDevices, false, false);
+}
+
+void Bm_UDisks2::cleanupTestCase()
+{
+    delete m_model;
+    m_model = nullptr;
+    delete m_manager;
+    m_manager = nullptr;
+
+    if (m_mock) {
+        QDBusConnection connection(QLatin1String(MockConnectionName));
+        connection.unregisterObject(QStringLiteral("/org/freedesktop/UDisks2"), QDBusConnection::UnregisterTree);
+        connection.unregisterService(QStringLiteral("org.freedesktop.UDisks2"));
+        QDBusConnection::disconnectFromBus(QLatin1String(MockConnectionName));
+
+        delete m_mock;
+        m_mock = nullptr;
+    }
+
+    if (m_bus && m_bus->state() != QProcess::NotRunning) {
+        m_bus->terminate();
+        m_bus->waitForFinished();
+    }
+}
+
+int Bm_UDisks2::externalCount() const
+{
+    return m_manager->partitions(Partition::External).count();
+}
+
+int Bm_UDisks2::mountedCount() const
+{
+    int count = 0;
+    for (const Partition &partition : m_manager->partitions(Partition::External)) {
+        if (partition.status() == Partition::Mounted) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool Bm_UDisks2::allLabeled(const QString &label) const
+{
+    for (const Partition &partition : m_manager->partitions(Partition::External)) {
+        if (partition.deviceLabel() != label) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Bm_UDisks2::report(const char *name, qint64 elapsed, int calls, int devices)
+{
+    qInfo("%s: %d devices in %lld ms, %.2f D-Bus calls per device",
+          name, devices, elapsed, devices > 0 ? qreal(calls) / devices : 0.0);
+    QTest::setBenchmarkResult(elapsed, QTest::WalltimeMilliseconds);
+}
+
+// Time from creating the first PartitionManager until every device present
+// at startup is exposed as a partition.
+void Bm_UDisks2::populate()
+{
+    m_mock->resetCalls();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_manager = new PartitionManager;
+    QTRY_COMPARE_WITH_TIMEOUT(externalCount(), m_initialDevices, Timeout);
+
+    report("time-to-populated", timer.elapsed(), m_mock->callCount(), m_initialDevices);
+    qInfo() << "Calls:" << m_mock->calls();
+}
+
+void Bm_UDisks2::hotplugStorm()
+{
+    m_mock->resetCalls();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_mock->addDevices(m_stormDevices);
+    QTRY_COMPARE_WITH_TIMEOUT(externalCount(), m_initialDevices + m_stormDevices, Timeout);
+
+    report("hotplug-storm", timer.elapsed(), m_mock->callCount(), m_stormDevices);
+}
+
+// Main thread CPU time spent per Block PropertiesChanged signal, from the
+// D-Bus dispatch to the updated partition.
+void Bm_UDisks2::propertiesChanged()
+{
+    const QStringList devices = m_mock->devices();
+    const QString label = QStringLiteral("relabeled");
+
+    m_mock->resetCalls();
+    const qint64 cpu = threadCpuTime();
+    QElapsedTimer timer;
+    timer.start();
+
+    m_mock->setLabel(devices, label);
+    QTRY_VERIFY_WITH_TIMEOUT(allLabeled(label), Timeout);
+
+    const qint64 cpuPerSignal = (threadCpuTime() - cpu) / devices.count();
+    qInfo("cpu-per-properties-changed: %lld us", cpuPerSignal);
+    report("properties-changed", timer.elapsed(), m_mock->callCount(), devices.count());
+}
+
+void Bm_UDisks2::mountStorm()
+{
+    m_model = new PartitionModel;
+    m_model->setStorageTypes(PartitionModel::External);
+
+    m_mock->resetCalls();
+    QElapsedTimer timer;
+    timer.start();
+
+    for (const Partition &partition : m_manager->partitions(Partition::External)) {
+        m_model->mount(partition.devicePath());
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(mountedCount(), externalCount(), Timeout);
+
+    report("mount-storm", timer.elapsed(), m_mock->callCount(), externalCount());
+}
+
+void Bm_UDisks2::hotunplugStorm()
+{
+    const QStringList devices = m_mock->devices();
+
+    m_mock->resetCalls();
+    QElapsedTimer timer;
+    timer.start();
+
+    m_mock->removeDevices(devices);
+    QTRY_COMPARE_WITH_TIMEOUT(externalCount(), 0, Timeout);
+
+    report("hotunplug-storm", timer.elapsed(), m_mock->callCount(), devices.count());
+}
+
+QTEST_GUILESS_MAIN(Bm_UDisks2)
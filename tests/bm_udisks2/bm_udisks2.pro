@@ -0,0 +1,29 @@
+PACKAGENAME = nemo-qml-plugin-systemsettings
+
+QT += testlib dbus
+QT -= gui
+
+TEMPLATE = app
+TARGET = bm_udisks2
+
+CONFIG += c++11
+
+target.path = /opt/tests/$${PACKAGENAME}-tests
+
+QMAKE_EXTRA_TARGETS = check
+
+check.depends = $$TARGET
+check.commands = LD_LIBRARY_PATH=../../src ./$$TARGET
+
+INCLUDEPATH += ../../src/
+LIBS += -L../../src -lsystemsettings
+
+SOURCES += \
+    bm_udisks2.cpp \
+    mockudisks2.cpp
+
+HEADERS += \
+    bm_udisks2.h \
+    mockudisks2.h
+
+INSTALLS += target
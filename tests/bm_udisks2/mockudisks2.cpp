@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "mockudisks2.h"
+
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusObjectPath>
+#include <QDBusVariant>
+#include <QMutexLocker>
+
+namespace {
+
+const QString Service = QStringLiteral("org.freedesktop.UDisks2");
+const QString RootPath = QStringLiteral("/org/freedesktop/UDisks2");
+const QString BlockDevicesPath = QStringLiteral("/org/freedesktop/UDisks2/block_devices/");
+const QString DrivesPath = QStringLiteral("/org/freedesktop/UDisks2/drives/");
+const QString JobsPath = QStringLiteral("/org/freedesktop/UDisks2/jobs/");
+
+const QString ObjectManagerInterface = QStringLiteral("org.freedesktop.DBus.ObjectManager");
+const QString PropertiesInterface = QStringLiteral("org.freedesktop.DBus.Properties");
+const QString BlockInterface = QStringLiteral("org.freedesktop.UDisks2.Block");
+const QString FilesystemInterface = QStringLiteral("org.freedesktop.UDisks2.Filesystem");
+const QString EncryptedInterface = QStringLiteral("org.freedesktop.UDisks2.Encrypted");
+const QString DriveInterface = QStringLiteral("org.freedesktop.UDisks2.Drive");
+const QString JobInterface = QStringLiteral("org.freedesktop.UDisks2.Job");
+
+QByteArray nulTerminated(const QString &string)
+{
+    QByteArray bytes = string.toUtf8();
+    bytes.append('\0');
+    return bytes;
+}
+
+}
+
+typedef QMap<QDBusObjectPath, QMap<QString, QVariantMap>> ManagedObjects;
+
+MockUDisks2::MockUDisks2(const QDBusConnection &connection, QObject *parent)
+    : QDBusVirtualObject(parent)
+    , m_connection(connection)
+    , m_nextDevice(0)
+    , m_nextJob(0)
+{
+}
+
+MockUDisks2::~MockUDisks2()
+{
+}
+
+void MockUDisks2::registerMetaTypes()
+{
+    qDBusRegisterMetaType<QMap<QString, QVariantMap>>();
+    qDBusRegisterMetaType<ManagedObjects>();
+    qDBusRegisterMetaType<QList<QByteArray>>();
+    qDBusRegisterMetaType<QList<QDBusObjectPath>>();
+}
+
+QString MockUDisks2::blockPath(const QString &name)
+{
+    return BlockDevicesPath + name;
+}
+
+QString MockUDisks2::drivePath(const QString &name)
+{
+    return DrivesPath + name;
+}
+
+QString MockUDisks2::deviceName(const QString &path)
+{
+    return path.startsWith(BlockDevicesPath) ? path.mid(BlockDevicesPath.length()) : QString();
+}
+
+QStringList MockUDisks2::addDevices(int count, bool encrypted, bool announce)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QStringList names;
+    for (int i = 0; i < count; ++i) {
+        const QString name = QStringLiteral("mock%1").arg(m_nextDevice++);
+        Device device;
+        device.label = name;
+        device.idType = encrypted ? QStringLiteral("crypto_LUKS") : QStringLiteral("vfat");
+        device.encrypted = encrypted;
+        m_devices.insert(name, device);
+        names.append(name);
+
+        if (announce) {
+            InterfaceMap drive;
+            drive.insert(DriveInterface, driveProperties(name));
+            emitInterfacesAdded(drivePath(name), drive);
+            emitInterfacesAdded(blockPath(name), interfaces(name, device));
+        }
+    }
+    return names;
+}
+
+void MockUDisks2::removeDevices(const QStringList &names)
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (const QString &name : names) {
+        if (!m_devices.contains(name)) {
+            continue;
+        }
+
+        const Device device = m_devices.take(name);
+        if (!device.cleartextDevice.isEmpty()) {
+            const Device cleartext = m_devices.take(device.cleartextDevice);
+            emitInterfacesRemoved(blockPath(device.cleartextDevice), interfaces(device.cleartextDevice, cleartext).keys());
+        }
+
+        emitInterfacesRemoved(blockPath(name), interfaces(name, device).keys());
+        emitInterfacesRemoved(drivePath(name), QStringList() << DriveInterface);
+    }
+}
+
+QStringList MockUDisks2::devices() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_devices.keys();
+}
+
+void MockUDisks2::setLabel(const QStringList &names, const QString &label)
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (const QString &name : names) {
+        const auto device = m_devices.find(name);
+        if (device != m_devices.end()) {
+            device->label = label;
+            QVariantMap changed;
+            changed.insert(QStringLiteral("IdLabel"), label);
+            emitPropertiesChanged(blockPath(name), BlockInterface, changed);
+        }
+    }
+}
+
+int MockUDisks2::callCount() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    int count = 0;
+    for (int calls : m_calls) {
+        count += calls;
+    }
+    return count;
+}
+
+QHash<QString, int> MockUDisks2::calls() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_calls;
+}
+
+void MockUDisks2::resetCalls()
+{
+    QMutexLocker locker(&m_mutex);
+    m_calls.clear();
+}
+
+MockUDisks2::InterfaceMap MockUDisks2::interfaces(const QString &name, const Device &device) const
+{
+    const bool cleartext = !device.backingDevice.isEmpty();
+
+    QVariantMap block;
+    block.insert(QStringLiteral("Device"), nulTerminated(QStringLiteral("/dev/") + name));
+    block.insert(QStringLiteral("PreferredDevice"), nulTerminated(QStringLiteral("/dev/") + name));
+    block.insert(QStringLiteral("Symlinks"), QVariant::fromValue(QList<QByteArray>()));
+    block.insert(QStringLiteral("DeviceNumber"), quint64(m_nextDevice));
+    block.insert(QStringLiteral("Id"), QStringLiteral("by-id-") + name);
+    block.insert(QStringLiteral("Size"), quint64(32) * 1024 * 1024 * 1024);
+    block.insert(QStringLiteral("ReadOnly"), false);
+    block.insert(QStringLiteral("Drive"), QVariant::fromValue(QDBusObjectPath(
+            cleartext ? QStringLiteral("/") : drivePath(name))));
+    block.insert(QStringLiteral("IdUsage"), cleartext || !device.encrypted ? QStringLiteral("filesystem") : QStringLiteral("crypto"));
+    block.insert(QStringLiteral("IdType"), device.idType);
+    block.insert(QStringLiteral("IdVersion"), QString());
+    block.insert(QStringLiteral("IdLabel"), device.label);
+    block.insert(QStringLiteral("IdUUID"), QStringLiteral("uuid-") + name);
+    block.insert(QStringLiteral("CryptoBackingDevice"), QVariant::fromValue(QDBusObjectPath(
+            cleartext ? blockPath(device.backingDevice) : QStringLiteral("/"))));
+    block.insert(QStringLiteral("HintAuto"), true);
+    block.insert(QStringLiteral("HintIgnore"), false);
+
+    InterfaceMap interfaces;
+    interfaces.insert(BlockInterface, block);
+
+    if (device.encrypted) {
+        QVariantMap encrypted;
+        encrypted.insert(QStringLiteral("CleartextDevice"), QVariant::fromValue(QDBusObjectPath(
+                device.cleartextDevice.isEmpty() ? QStringLiteral("/") : blockPath(device.cleartextDevice))));
+        interfaces.insert(EncryptedInterface, encrypted);
+    } else {
+        QVariantMap filesystem;
+        QList<QByteArray> mountPoints;
+        if (!device.mountPoint.isEmpty()) {
+            mountPoints.append(device.mountPoint);
+        }
+        filesystem.insert(QStringLiteral("MountPoints"), QVariant::fromValue(mountPoints));
+        filesystem.insert(QStringLiteral("Size"), quint64(32) * 1024 * 1024 * 1024);
+        interfaces.insert(FilesystemInterface, filesystem);
+    }
+
+    return interfaces;
+}
+
+QVariantMap MockUDisks2::driveProperties(const QString &name) const
+{
+    QVariantMap drive;
+    drive.insert(QStringLiteral("Vendor"), QStringLiteral("Mock"));
+    drive.insert(QStringLiteral("Model"), QStringLiteral("Card ") + name);
+    drive.insert(QStringLiteral("ConnectionBus"), QStringLiteral("sdio"));
+    drive.insert(QStringLiteral("Removable"), true);
+    return drive;
+}
+
+void MockUDisks2::emitInterfacesAdded(const QString &path, const InterfaceMap &interfaces)
+{
+    QDBusMessage signal = QDBusMessage::createSignal(RootPath, ObjectManagerInterface, QStringLiteral("InterfacesAdded"));
+    signal << QVariant::fromValue(QDBusObjectPath(path)) << QVariant::fromValue(interfaces);
+    m_connection.send(signal);
+}
+
+void MockUDisks2::emitInterfacesRemoved(const QString &path, const QStringList &interfaces)
+{
+    QDBusMessage signal = QDBusMessage::createSignal(RootPath, ObjectManagerInterface, QStringLiteral("InterfacesRemoved"));
+    signal << QVariant::fromValue(QDBusObjectPath(path)) << interfaces;
+    m_connection.send(signal);
+}
+
+void MockUDisks2::emitPropertiesChanged(const QString &path, const QString &interface, const QVariantMap &properties)
+{
+    QDBusMessage signal = QDBusMessage::createSignal(path, PropertiesInterface, QStringLiteral("PropertiesChanged"));
+    signal << interface << properties << QStringList();
+    m_connection.send(signal);
+}
+
+// Jobs complete immediately, but the signal sequence matches udisksd.
+void MockUDisks2::runJob(const QString &operation, const QString &objectPath)
+{
+    const QString path = JobsPath + QString::number(m_nextJob++);
+
+    QVariantMap job;
+    job.insert(QStringLiteral("Operation"), operation);
+    job.insert(QStringLiteral("Objects"), QVariant::fromValue(QList<QDBusObjectPath>() << QDBusObjectPath(objectPath)));
+    job.insert(QStringLiteral("Progress"), 0.0);
+    job.insert(QStringLiteral("ProgressValid"), false);
+    job.insert(QStringLiteral("Bytes"), quint64(0));
+    job.insert(QStringLiteral("Rate"), quint64(0));
+    job.insert(QStringLiteral("ExpectedEndTime"), quint64(0));
+    job.insert(QStringLiteral("Cancelable"), false);
+
+    InterfaceMap interfaces;
+    interfaces.insert(JobInterface, job);
+    emitInterfacesAdded(path, interfaces);
+
+    QDBusMessage completed = QDBusMessage::createSignal(path, JobInterface, QStringLiteral("Completed"));
+    completed << true << QString();
+    m_connection.send(completed);
+
+    emitInterfacesRemoved(path, QStringList() << JobInterface);
+}
+
+QString MockUDisks2::introspect(const QString &path) const
+{
+    Q_UNUSED(path)
+    return QString();
+}
+
+bool MockUDisks2::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    if (message.type() != QDBusMessage::MethodCallMessage) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    ++m_calls[message.interface() + QLatin1Char('.') + message.member()];
+
+    QDBusMessage reply;
+    if (message.interface() == ObjectManagerInterface) {
+        reply = handleObjectManager(message);
+    } else if (message.interface() == PropertiesInterface) {
+        reply = handleProperties(message);
+    } else {
+        reply = handleBlock(message);
+    }
+
+    connection.send(reply);
+    return true;
+}
+
+QDBusMessage MockUDisks2::handleObjectManager(const QDBusMessage &message)
+{
+    if (message.member() != QLatin1String("GetManagedObjects") || message.path() != RootPath) {
+        return message.createErrorReply(QDBusError::UnknownMethod, message.member());
+    }
+
+    ManagedObjects objects;
+    for (auto it = m_devices.constBegin(); it != m_devices.constEnd(); ++it) {
+        objects.insert(QDBusObjectPath(blockPath(it.key())), interfaces(it.key(), it.value()));
+        if (it->backingDevice.isEmpty()) {
+            InterfaceMap drive;
+            drive.insert(DriveInterface, driveProperties(it.key()));
+            objects.insert(QDBusObjectPath(drivePath(it.key())), drive);
+        }
+    }
+    return message.createReply(QVariant::fromValue(objects));
+}
+
+QDBusMessage MockUDisks2::handleProperties(const QDBusMessage &message)
+{
+    const QString path = message.path();
+    const QString interface = message.arguments().value(0).toString();
+
+    QVariantMap properties;
+    if (path.startsWith(DrivesPath)) {
+        const QString name = path.mid(DrivesPath.length());
+        if (m_devices.contains(name) && interface == DriveInterface) {
+            properties = driveProperties(name);
+        }
+    } else {
+        const QString name = deviceName(path);
+        const auto device = m_devices.constFind(name);
+        if (device == m_devices.constEnd()) {
+            return message.createErrorReply(QDBusError::UnknownObject, path);
+        }
+        // Interfaces the object does not implement return an empty map,
+        // the client treats those as absent.
+        properties = interfaces(name, *device).value(interface);
+    }
+
+    if (message.member() == QLatin1String("GetAll")) {
+        return message.createReply(properties);
+    } else if (message.member() == QLatin1String("Get")) {
+        return message.createReply(QVariant::fromValue(QDBusVariant(properties.value(message.arguments().value(1).toString()))));
+    }
+    return message.createErrorReply(QDBusError::UnknownMethod, message.member());
+}
+
+QDBusMessage MockUDisks2::handleBlock(const QDBusMessage &message)
+{
+    const QString path = message.path();
+    const QString name = deviceName(path);
+    const auto device = m_devices.find(name);
+    if (device == m_devices.end()) {
+        return message.createErrorReply(QDBusError::UnknownObject, path);
+    }
+
+    const QString interface = message.interface();
+    const QString member = message.member();
+
+    if (interface == FilesystemInterface && member == QLatin1String("Mount")) {
+        if (!device->mountPoint.isEmpty()) {
+            return message.createErrorReply(QStringLiteral("org.freedesktop.UDisks2.Error.AlreadyMounted"), path);
+        }
+        device->mountPoint = QByteArray("/run/media/mock/") + name.toUtf8();
+        runJob(QStringLiteral("filesystem-mount"), path);
+        QVariantMap changed;
+        changed.insert(QStringLiteral("MountPoints"), QVariant::fromValue(QList<QByteArray>() << device->mountPoint));
+        emitPropertiesChanged(path, FilesystemInterface, changed);
+        return message.createReply(QString::fromUtf8(device->mountPoint));
+    } else if (interface == FilesystemInterface && member == QLatin1String("Unmount")) {
+        if (device->mountPoint.isEmpty()) {
+            return message.createErrorReply(QStringLiteral("org.freedesktop.UDisks2.Error.NotMounted"), path);
+        }
+        device->mountPoint.clear();
+        runJob(QStringLiteral("filesystem-unmount"), path);
+        QVariantMap changed;
+        changed.insert(QStringLiteral("MountPoints"), QVariant::fromValue(QList<QByteArray>()));
+        emitPropertiesChanged(path, FilesystemInterface, changed);
+        return message.createReply();
+    } else if (interface == BlockInterface && member == QLatin1String("Format")) {
+        device->idType = message.arguments().value(0).toString();
+        device->label = QString();
+        runJob(QStringLiteral("format-mkfs"), path);
+        QVariantMap changed;
+        changed.insert(QStringLiteral("IdType"), device->idType);
+        changed.insert(QStringLiteral("IdLabel"), device->label);
+        emitPropertiesChanged(path, BlockInterface, changed);
+        return message.createReply();
+    } else if (interface == EncryptedInterface && member == QLatin1String("Unlock") && device->encrypted) {
+        if (!device->cleartextDevice.isEmpty()) {
+            return message.createErrorReply(QStringLiteral("org.freedesktop.UDisks2.Error.Failed"), path);
+        }
+        const QString cleartextName = QStringLiteral("dm-%1").arg(m_nextDevice++);
+        Device cleartext;
+        cleartext.label = device->label;
+        cleartext.idType = QStringLiteral("vfat");
+        cleartext.backingDevice = name;
+        device->cleartextDevice = cleartextName;
+        m_devices.insert(cleartextName, cleartext);
+
+        runJob(QStringLiteral("encrypted-unlock"), path);
+        emitInterfacesAdded(blockPath(cleartextName), interfaces(cleartextName, cleartext));
+        return message.createReply(QVariant::fromValue(QDBusObjectPath(blockPath(cleartextName))));
+    } else if (interface == EncryptedInterface && member == QLatin1String("Lock") && device->encrypted) {
+        if (device->cleartextDevice.isEmpty()) {
+            return message.createErrorReply(QStringLiteral("org.freedesktop.UDisks2.Error.Failed"), path);
+        }
+        const QString cleartextName = device->cleartextDevice;
+        device->cleartextDevice.clear();
+        const QStringList removed = interfaces(cleartextName, m_devices.value(cleartextName)).keys();
+        m_devices.remove(cleartextName);
+
+        runJob(QStringLiteral("encrypted-lock"), path);
+        emitInterfacesRemoved(blockPath(cleartextName), removed);
+        return message.createReply();
+    }
+
+    return message.createErrorReply(QDBusError::UnknownMethod, member);
+}
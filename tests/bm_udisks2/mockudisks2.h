@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef MOCKUDISKS2_H
+#define MOCKUDISKS2_H
+
+#include <QDBusConnection>
+#include <QDBusVirtualObject>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QStringList>
+
+// A minimal stand-in for udisksd implementing the ObjectManager,
+// Properties, Block, Filesystem, Encrypted and Job interfaces well enough
+// for UDisks2::Monitor. Method calls are answered on the D-Bus thread of
+// QtDBus, the scripting functions can be called from any thread.
+class MockUDisks2 : public QDBusVirtualObject
+{
+    Q_OBJECT
+
+public:
+    explicit MockUDisks2(const QDBusConnection &connection, QObject *parent = nullptr);
+    ~MockUDisks2();
+
+    static void registerMetaTypes();
+
+    // Adds a drive and an unmounted vfat file system block for each device
+    // and returns the device names. Encrypted devices start locked.
+    QStringList addDevices(int count, bool encrypted = false, bool announce = true);
+    void removeDevices(const QStringList &names);
+    QStringList devices() const;
+
+    // Emits one PropertiesChanged per device.
+    void setLabel(const QStringList &names, const QString &label);
+
+    int callCount() const;
+    QHash<QString, int> calls() const;
+    void resetCalls();
+
+    QString introspect(const QString &path) const override;
+    bool handleMessage(const QDBusMessage &message, const QDBusConnection &connection) override;
+
+private:
+    typedef QMap<QString, QVariantMap> InterfaceMap;
+
+    struct Device
+    {
+        QString label;
+        QString idType;
+        QByteArray mountPoint;
+        QString backingDevice;  // Cleartext devices only
+        QString cleartextDevice;  // Unlocked encrypted devices only
+        bool encrypted = false;
+    };
+
+    static QString blockPath(const QString &name);
+    static QString drivePath(const QString &name);
+    static QString deviceName(const QString &path);
+
+    InterfaceMap interfaces(const QString &name, const Device &device) const;
+    QVariantMap driveProperties(const QString &name) const;
+
+    void emitInterfacesAdded(const QString &path, const InterfaceMap &interfaces);
+    void emitInterfacesRemoved(const QString &path, const QStringList &interfaces);
+    void emitPropertiesChanged(const QString &path, const QString &interface, const QVariantMap &properties);
+    void runJob(const QString &operation, const QString &objectPath);
+
+    QDBusMessage handleObjectManager(const QDBusMessage &message);
+    QDBusMessage handleProperties(const QDBusMessage &message);
+    QDBusMessage handleBlock(const QDBusMessage &message);
+
+    mutable QMutex m_mutex;
+    QDBusConnection m_connection;
+    QMap<QString, Device> m_devices;
+    QHash<QString, int> m_calls;
+    int m_nextDevice;
+    int m_nextJob;
+};
+
+#endif
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2026 Jolla Ltd.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "ut_timezoneinfo.h"
+
+#include <timezoneindex_p.h>
+#include <timezoneinfo_p.h>
+
+#include <QDateTime>
+#include <QtEndian>
+#include <QtTest>
+
+// Expected values were taken from glibc localtime_r() with the same TZ strings.
+
+namespace {
+
+struct LocalTimeType
+{
+    qint32 offset;
+    bool isDst;
+};
+
+void appendBigEndian(QByteArray *data, qint64 value, int size)
+{
+    uchar bytes[8];
+    if (size == 8) {
+        qToBigEndian<qint64>(value, bytes);
+    } else {
+        qToBigEndian<qint32>(qint32(value), bytes);
+    }
+    data->append(reinterpret_cast<const char *>(bytes), size);
+}
+
+// One TZif header and data block, every type uses the abbreviation "ZZZ".
+QByteArray zoneInfoBlock(char version, int timeSize, const QVector<qint64> &times,
+                         const QVector<int> &typeIndexes, const QVector<LocalTimeType> &types)
+{
+    QByteArray block("TZif");
+    block.append(version);
+    block.append(QByteArray(15, '\0'));
+    appendBigEndian(&block, 0, 4);                  // tzh_ttisutcnt
+    appendBigEndian(&block, 0, 4);                  // tzh_ttisstdcnt
+    appendBigEndian(&block, 0, 4);                  // tzh_leapcnt
+    appendBigEndian(&block, times.count(), 4);      // tzh_timecnt
+    appendBigEndian(&block, types.count(), 4);      // tzh_typecnt
+    appendBigEndian(&block, 4, 4);                  // tzh_charcnt
+
+    for (qint64 time : times) {
+        appendBigEndian(&block, time, timeSize);
+    }
+    for (int index : typeIndexes) {
+        block.append(char(index));
+    }
+    for (const LocalTimeType &type : types) {
+        appendBigEndian(&block, type.offset, 4);
+        block.append(char(type.isDst ? 1 : 0));
+        block.append('\0');
+    }
+    block.append("ZZZ", 4);
+    return block;
+}
+
+// New York from 1883 with the 2023 transitions and the current rule.
+const QVector<LocalTimeType> NewYorkTypes = {
+    { -17762, false },          // LMT
+    { -18000, false },          // EST
+    { -14400, true },           // EDT
+    { -18000, false }           // EST under another abbreviation, not a change
+};
+const QVector<qint64> NewYorkTimes = { -2717650800, 1678604400, 1699164000, 1701388800 };
+const QVector<int> NewYorkTypeIndexes = { 1, 2, 1, 3 };
+const char * const NewYorkRule = "EST5EDT,M3.2.0,M11.1.0";
+
+QByteArray newYorkVersion2()
+{
+    // The 32-bit block of a version 2 file is skipped, leave it without transitions.
+    QByteArray data = zoneInfoBlock('2', 4, QVector<qint64>(), QVector<int>(), NewYorkTypes.mid(0, 1));
+    data += zoneInfoBlock('2', 8, NewYorkTimes, NewYorkTypeIndexes, NewYorkTypes);
+    data += '\n';
+    data += NewYorkRule;
+    data += '\n';
+    return data;
+}
+
+bool parse(const QByteArray &data, TimeZoneIndex::Zone *zone)
+{
+    return TimeZoneInfoPrivate::parseZoneInfoData(reinterpret_cast<const uchar *>(data.constData()), data.size(), zone);
+}
+
+}
+
+void Ut_TimeZoneInfo::testRule_data()
+{
+    QTest::addColumn<QByteArray>("rule");
+    QTest::addColumn<qint64>("time");
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<bool>("isDst");
+
+    // Mm.w.d, the last Sunday with the end at 03:00 daylight time.
+    const QByteArray central("CET-1CEST,M3.5.0,M10.5.0/3");
+    QTest::newRow("Mm.w.d before start") << central << Q_INT64_C(1711846799) << 3600 << false;
+    QTest::newRow("Mm.w.d at start") << central << Q_INT64_C(1711846800) << 7200 << true;
+    QTest::newRow("Mm.w.d before end") << central << Q_INT64_C(1729990799) << 7200 << true;
+    QTest::newRow("Mm.w.d at end") << central << Q_INT64_C(1729990800) << 3600 << false;
+
+    // Mm.w.d, the second Sunday.
+    const QByteArray eastern("EST5EDT,M3.2.0,M11.1.0");
+    QTest::newRow("Mm.w.d second week before") << eastern << Q_INT64_C(1173596399) << -18000 << false;
+    QTest::newRow("Mm.w.d second week at") << eastern << Q_INT64_C(1173596400) << -14400 << true;
+
+    // Jn never counts February 29, J60 is March 1 in leap years too.
+    const QByteArray julian("EST5EDT,J60,J300");
+    QTest::newRow("Jn leap year before start") << julian << Q_INT64_C(1709276399) << -18000 << false;
+    QTest::newRow("Jn leap year at start") << julian << Q_INT64_C(1709276400) << -14400 << true;
+    QTest::newRow("Jn leap year before end") << julian << Q_INT64_C(1730008799) << -14400 << true;
+    QTest::newRow("Jn leap year at end") << julian << Q_INT64_C(1730008800) << -18000 << false;
+    QTest::newRow("Jn common year before start") << julian << Q_INT64_C(1677653999) << -18000 << false;
+    QTest::newRow("Jn common year at start") << julian << Q_INT64_C(1677654000) << -14400 << true;
+
+    // n is zero based and counts February 29, day 59 is February 29 in leap years.
+    const QByteArray zeroBased("EST5EDT,59,299");
+    QTest::newRow("n leap year before start") << zeroBased << Q_INT64_C(1709189999) << -18000 << false;
+    QTest::newRow("n leap year at start") << zeroBased << Q_INT64_C(1709190000) << -14400 << true;
+    QTest::newRow("n common year before start") << zeroBased << Q_INT64_C(1677653999) << -18000 << false;
+    QTest::newRow("n common year at start") << zeroBased << Q_INT64_C(1677654000) << -14400 << true;
+    QTest::newRow("n leap year before end") << zeroBased << Q_INT64_C(1729922399) << -14400 << true;
+    QTest::newRow("n leap year at end") << zeroBased << Q_INT64_C(1729922400) << -18000 << false;
+
+    // Southern hemisphere, daylight saving time wraps the end of the year.
+    const QByteArray southern("AEST-10AEDT,M10.1.0,M4.1.0/3");
+    QTest::newRow("southern January") << southern << Q_INT64_C(1705276800) << 39600 << true;
+    QTest::newRow("southern before end") << southern << Q_INT64_C(1712419199) << 39600 << true;
+    QTest::newRow("southern at end") << southern << Q_INT64_C(1712419200) << 36000 << false;
+    QTest::newRow("southern June") << southern << Q_INT64_C(1718409600) << 36000 << false;
+    QTest::newRow("southern before start") << southern << Q_INT64_C(1728143999) << 36000 << false;
+    QTest::newRow("southern at start") << southern << Q_INT64_C(1728144000) << 39600 << true;
+    QTest::newRow("southern end of year") << southern << Q_INT64_C(1735689599) << 39600 << true;
+
+    // Version 3 extensions, hours beyond 24 and negative times of day.
+    const QByteArray israel("IST-2IDT,M3.4.4/26,M10.5.0");
+    QTest::newRow("hour 26 before start") << israel << Q_INT64_C(1711670399) << 7200 << false;
+    QTest::newRow("hour 26 at start") << israel << Q_INT64_C(1711670400) << 10800 << true;
+    QTest::newRow("hour 26 before end") << israel << Q_INT64_C(1729983599) << 10800 << true;
+    QTest::newRow("hour 26 at end") << israel << Q_INT64_C(1729983600) << 7200 << false;
+
+    const QByteArray greenland("<-02>2<-01>,M3.5.0/-1,M10.5.0/0");
+    QTest::newRow("negative hour before start") << greenland << Q_INT64_C(1711846799) << -7200 << false;
+    QTest::newRow("negative hour at start") << greenland << Q_INT64_C(1711846800) << -3600 << true;
+    QTest::newRow("negative hour before end") << greenland << Q_INT64_C(1729990799) << -3600 << true;
+    QTest::newRow("negative hour at end") << greenland << Q_INT64_C(1729990800) << -7200 << false;
+
+    QTest::newRow("no daylight saving") << QByteArray("JST-9") << Q_INT64_C(1719792000) << 32400 << false;
+}
+
+void Ut_TimeZoneInfo::testRule()
+{
+    QFETCH(QByteArray, rule);
+    QFETCH(qint64, time);
+    QFETCH(int, offset);
+    QFETCH(bool, isDst);
+
+    TimeZoneIndex::LocalTime localTime;
+    QVERIFY(TimeZoneIndex::evaluateRule(rule.constData(), time, &localTime));
+    QCOMPARE(int(localTime.offset), offset);
+    QCOMPARE(bool(localTime.isDst), isDst);
+}
+
+void Ut_TimeZoneInfo::testInvalidRule()
+{
+    TimeZoneIndex::LocalTime localTime;
+    QVERIFY(!TimeZoneIndex::evaluateRule("", 0, &localTime));
+    QVERIFY(!TimeZoneIndex::evaluateRule("CET-1CEST,M13.1.0,M10.5.0", 0, &localTime));
+    QVERIFY(!TimeZoneIndex::evaluateRule("CET-1CEST,M3.5.0", 0, &localTime));
+    QVERIFY(!TimeZoneIndex::evaluateRule("CET-1CEST,M3.5.0,M10.5.0/168", 0, &localTime));
+}
+
+void Ut_TimeZoneInfo::testVersion1()
+{
+    // Version 1 files have only 32-bit times, which cannot hold the 1883 transition.
+    const QByteArray data = zoneInfoBlock('\0', 4, NewYorkTimes.mid(1), NewYorkTypeIndexes.mid(1), NewYorkTypes);
+
+    TimeZoneIndex::Zone zone;
+    QVERIFY(parse(data, &zone));
+    QCOMPARE(int(zone.initial.offset), -17762);
+    QCOMPARE(int(zone.initial.isDst), 0);
+    QCOMPARE(zone.offset, -18000);
+    QVERIFY(zone.rule.isEmpty());
+
+    QCOMPARE(zone.transitions.count(), 2);
+    QCOMPARE(zone.transitions.at(0).time, Q_INT64_C(1678604400));
+    QCOMPARE(int(zone.transitions.at(0).localTime.offset), -14400);
+    QCOMPARE(int(zone.transitions.at(0).localTime.isDst), 1);
+    QCOMPARE(zone.transitions.at(1).time, Q_INT64_C(1699164000));
+    QCOMPARE(int(zone.transitions.at(1).localTime.offset), -18000);
+    QCOMPARE(int(zone.transitions.at(1).localTime.isDst), 0);
+
+    TimeZoneIndex::Zone truncated;
+    QVERIFY(!parse(data.left(data.size() - 1), &truncated));
+    TimeZoneIndex::Zone badMagic;
+    QVERIFY(!parse(QByteArray("TZjf") + data.mid(4), &badMagic));
+}
+
+void Ut_TimeZoneInfo::testVersion2()
+{
+    const QByteArray data = newYorkVersion2();
+
+    TimeZoneIndex::Zone zone;
+    QVERIFY(parse(data, &zone));
+    QCOMPARE(zone.rule, QByteArray(NewYorkRule));
+    QCOMPARE(zone.offset, -18000);
+    QCOMPARE(zone.transitions.count(), 3);
+    QCOMPARE(zone.transitions.at(0).time, Q_INT64_C(-2717650800));
+    QCOMPARE(int(zone.transitions.at(0).localTime.offset), -18000);
+    QCOMPARE(zone.transitions.at(2).time, Q_INT64_C(1699164000));
+
+    // Without the footer the zone has no rule for later times.
+    TimeZoneIndex::Zone withoutRule;
+    QVERIFY(parse(data.left(data.size() - qstrlen(NewYorkRule) - 2), &withoutRule));
+    QVERIFY(withoutRule.rule.isEmpty());
+    QCOMPARE(withoutRule.transitions.count(), 3);
+}
+
+void Ut_TimeZoneInfo::testOffsetAt_data()
+{
+    QTest::addColumn<qint64>("time");
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<bool>("isDst");
+
+    QTest::newRow("local mean time") << Q_INT64_C(-2717650801) << -17762 << false;
+    QTest::newRow("standard time from 1883") << Q_INT64_C(-2717650800) << -18000 << false;
+    QTest::newRow("before transition to DST") << Q_INT64_C(1678604399) << -18000 << false;
+    QTest::newRow("transition to DST") << Q_INT64_C(1678604400) << -14400 << true;
+    QTest::newRow("before transition to standard") << Q_INT64_C(1699163999) << -14400 << true;
+    QTest::newRow("transition to standard") << Q_INT64_C(1699164000) << -18000 << false;
+    QTest::newRow("rule summer") << Q_INT64_C(1719792000) << -14400 << true;
+    QTest::newRow("rule winter") << Q_INT64_C(1736899200) << -18000 << false;
+}
+
+void Ut_TimeZoneInfo::testOffsetAt()
+{
+    QFETCH(qint64, time);
+    QFETCH(int, offset);
+    QFETCH(bool, isDst);
+
+    TimeZoneIndex::Zone zone;
+    QVERIFY(parse(newYorkVersion2(), &zone));
+    zone.name = "America/New_York";
+    zone.valid = true;
+
+    const QByteArray stamp("ut_timezoneinfo");
+    TimeZoneIndex *index = new TimeZoneIndex;
+    if (!index->load(TimeZoneIndex::build(stamp, QVector<TimeZoneIndex::Zone>() << zone), stamp)) {
+        delete index;
+        QFAIL("Index not loaded");
+    }
+    const TimeZoneInfo info = TimeZoneInfoPrivate::timeZoneInfo(index, 0);
+    QCOMPARE(info.name(), QByteArray("America/New_York"));
+    QCOMPARE(info.offset(), -18000);
+
+    const QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(time * 1000, Qt::UTC);
+    QCOMPARE(info.offsetAt(dateTime), offset);
+    QCOMPARE(info.isDstAt(dateTime), isDst);
+}
+
+QTEST_APPLESS_MAIN(Ut_TimeZoneInfo)
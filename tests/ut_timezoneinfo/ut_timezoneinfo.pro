@@ -0,0 +1,32 @@
+PACKAGENAME = nemo-qml-plugin-systemsettings
+
+QT += testlib
+QT -= gui
+
+TEMPLATE = app
+TARGET = ut_timezoneinfo
+
+CONFIG += c++11
+
+target.path = /opt/tests/$${PACKAGENAME}-tests
+
+QMAKE_EXTRA_TARGETS = check
+
+check.depends = $$TARGET
+check.commands = LD_LIBRARY_PATH=../../lib ./$$TARGET
+
+INCLUDEPATH += ../../src/
+
+SOURCES += ut_timezoneinfo.cpp
+HEADERS += ut_timezoneinfo.h
+
+SOURCES += \
+    ../../src/timezoneindex.cpp \
+    ../../src/timezoneinfo.cpp
+
+HEADERS += \
+    ../../src/timezoneindex_p.h \
+    ../../src/timezoneinfo.h \
+    ../../src/timezoneinfo_p.h
+
+INSTALLS += target